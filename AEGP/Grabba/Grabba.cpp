@@ -9,16 +9,14 @@ namespace py = pybind11;
 
 AEGP_PluginID myID = 3927L;
 
-void saveFrame(int i, LayerRenderOptionsPtr layerRenderOptions) {
-	LayerRenderOptionsSuite().setTime(layerRenderOptions, FramesToTime(i)); // Set the time of the layer render options
-	AsyncRenderManager rmanager; // Create an instance of the AsyncRenderManager class
-	rmanager.renderAsync(layerRenderOptions, [i](WorldPtr world) { // Call the renderAsync method with a lambda function
-		if (world) {
-			std::string folder = "C:\\Users\\tjerf\\Downloads\\pdf_output\\New folder\\";
-			auto data = Image::data(world); // Get the image data from the world
-			Image::saveImage(folder + "\\frame" + std::to_string(i) + ".png", "png", data); // Save the image to disk
-		}
-		});
+// Renders frames first..last and writes them as PNGs; rendering, conversion, encoding and writing overlap.
+// Blocks until done, so call it from a background thread.
+ae::ExportStats saveFrames(int first, int last, LayerRenderOptionsPtr layerRenderOptions, const TimeBase& base) {
+	ae::FrameSequenceExporterOptions options;
+	options.directory = "C:\\Users\\tjerf\\Downloads\\pdf_output\\New folder";
+	options.prefix = "frame";
+	ae::FrameSequenceExporter exporter(layerRenderOptions, options);
+	return exporter.run(first, last, base);
 }
 
 void GrabbaCommand::execute() {
@@ -75,7 +73,7 @@ void Grabba::onDeath()
 
 void Grabba::onIdle()
 {
-	ae::TaskScheduler::GetInstance().ExecuteTask();
+	// Scheduled tasks are drained by the plugin's idle hook.
 }
 
 DECLARE_ENTRY(Grabba, myID)
@@ -81,13 +81,22 @@ private:
         auto propName = prop->getName();
         auto matchName = prop->matchName();
         auto propType = StreamTypeToString(prop->getType());
-        auto numKeys = prop->numKeys();
+        // One main-thread hop for every key of the stream instead of several per key.
+        auto track = prop->getType() == StreamType::NONE ? ae::KeyframeTrack() : prop->getKeyframeTrack();
 
         outFile << indent(indentLevel) << "Property:\n"
             << indent(indentLevel + 1) << "Name: " << propName << "\n"
             << indent(indentLevel + 1) << "Match Name: " << matchName << "\n"
             << indent(indentLevel + 1) << "Type: " << propType << "\n"
-            << indent(indentLevel + 1) << "# of KeyFrames: " << numKeys << "\n";
+            << indent(indentLevel + 1) << "# of KeyFrames: " << track.size() << "\n";
+
+        for (std::size_t key = 0; key < track.size(); ++key) {
+            outFile << indent(indentLevel + 2) << "Key " << key << ": " << track.seconds(key) << "s";
+            for (int d = 0; d < track.dimensions; ++d) {
+                outFile << (d == 0 ? " = (" : ", ") << track.values[d][key];
+            }
+            outFile << (track.dimensions > 0 ? ")\n" : "\n");
+        }
     }
 
     // Enhanced property processing with clearer group delineation
@@ -13,7 +13,7 @@ void SkeletonCommand::updateMenu() {
 
 void Skeleton::onInit()
 {
-	
+	registerIdleHook(); // drains ae::TaskScheduler within its time budget
 }
 
 void Skeleton::onDeath()
@@ -80,12 +80,7 @@ void TaskScheduler::onDeath()
 
 void TaskScheduler::onIdle()
 {
-	try {
-		ae::TaskScheduler::GetInstance().ExecuteTask();
-	}
-	catch (const std::exception& e) {
-		App::Alert(e.what());
-	}
+	// Scheduled tasks are drained by the plugin's idle hook within its time budget.
 }
 
 DECLARE_ENTRY(TaskScheduler, myID)
@@ -21,14 +21,28 @@
 #include "AETK/AEGP/Template/Plugin.hpp"
 
 #include "AETK/AEGP/Util/AssetManager.hpp"
+#include "AETK/AEGP/Util/ChangeTracker.hpp"
+#include "AETK/AEGP/Util/CompSnapshot.hpp"
 #include "AETK/AEGP/Util/Context.hpp"
+#include "AETK/AEGP/Util/Coroutine.hpp"
 #include "AETK/AEGP/Util/Effects.hpp"
 #include "AETK/AEGP/Util/Factories.hpp"
+#include "AETK/AEGP/Util/FrameCache.hpp"
+#include "AETK/AEGP/Util/FrameSequenceExporter.hpp"
 #include "AETK/AEGP/Util/Image.hpp"
+#include "AETK/AEGP/Util/ImageView.hpp"
 #include "AETK/AEGP/Util/Keyframe.hpp"
+#include "AETK/AEGP/Util/KeyframeEvaluator.hpp"
+#include "AETK/AEGP/Util/KeyframeTrack.hpp"
 #include "AETK/AEGP/Util/Masks.hpp"
+#include "AETK/AEGP/Util/ProjectIndex.hpp"
 #include "AETK/AEGP/Util/Properties.hpp"
+#include "AETK/AEGP/Util/PropertySamples.hpp"
+#include "AETK/AEGP/Util/RenderPipeline.hpp"
+#include "AETK/AEGP/Util/Swizzle.hpp"
 #include "AETK/AEGP/Util/TaskScheduler.hpp"
+#include "AETK/AEGP/Util/Transaction.hpp"
+#include "AETK/AEGP/Util/WorkerPool.hpp"
 
 #include "AETK/AEGP/App.hpp"     // Application Class
 #include "AETK/AEGP/Items.hpp"   // Item Classes
@@ -36,35 +50,53 @@
 #include "AETK/AEGP/Project.hpp" // Project Class
 
 
+/**
+ * @class AsyncRenderManager
+ * @brief Renders a single layer frame asynchronously and calls back with its world.
+ *
+ * The callback runs on the main thread. The world is only valid during the callback, and is null when the render
+ * failed or was canceled. For frame ranges use ae::RenderPipeline, which bounds the requests in flight.
+ */
 class AsyncRenderManager
-    {
+{
   public:
     AsyncRenderManager() {}
 
-    // Method to initiate async rendering with an optional custom callback
+    // Issues the request from the main thread. The callback is owned by the request and freed once it has run.
     void renderAsync(LayerRenderOptionsPtr optionsH, std::function<void(WorldPtr)> callbackF)
     {
-        auto callbackPtr = new std::function<void(WorldPtr)>(callbackF);
-
-        auto ret = std::async(std::launch::async, [optionsH, callbackPtr]() {
-            RenderSuite().renderAndCheckoutLayerFrameAsync(optionsH, callback,
-                                                           reinterpret_cast<AEGP_AsyncFrameRequestRefcon>(callbackPtr));
+        auto callbackPtr = std::make_shared<std::function<void(WorldPtr)>>(std::move(callbackF));
+        ae::TaskScheduler::GetInstance().ScheduleTask([optionsH, callbackPtr]() {
+            auto owned = std::make_unique<std::function<void(WorldPtr)>>(std::move(*callbackPtr));
+            auto *renderSuite = SuiteManager::GetInstance().GetSuiteHandler().RenderSuite5();
+            AEGP_AsyncRequestId id = 0;
+            AE_CHECK(renderSuite->AEGP_RenderAndCheckoutLayerFrame_Async(
+                *optionsH, callback, reinterpret_cast<AEGP_AsyncFrameRequestRefcon>(owned.get()), &id));
+            owned.release(); // AE calls back exactly once for an accepted request
         });
     }
 
-
-    // Existing static callback method remains unchanged
     static A_Err callback(AEGP_AsyncRequestId request_id, A_Boolean was_canceled, A_Err error,
                           AEGP_FrameReceiptH receiptH, AEGP_AsyncFrameRequestRefcon refconP0)
     {
-        auto callbackPtr = reinterpret_cast<std::function<void(WorldPtr)> *>(refconP0);
+        std::unique_ptr<std::function<void(WorldPtr)>> callbackPtr(
+            reinterpret_cast<std::function<void(WorldPtr)> *>(refconP0));
 
         if (callbackPtr && *callbackPtr)
         {
-            FrameReceiptPtr ptr = makeFrameReceiptPtr(receiptH);
-            auto& world = RenderSuite().getReceiptWorld(ptr);
-            (*callbackPtr)(world);
-            delete callbackPtr;
+            try
+            {
+                WorldPtr world;
+                if (!was_canceled && error == A_Err_NONE && receiptH)
+                {
+                    world = RenderSuite().getReceiptWorld(makeFrameReceiptPtr(receiptH));
+                }
+                (*callbackPtr)(world);
+            }
+            catch (...)
+            {
+                // Errors cannot propagate through AE's callback.
+            }
         }
         return error;
     }
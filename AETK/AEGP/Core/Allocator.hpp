@@ -1,6 +1,7 @@
 /*****************************************************************/ /**
                                                                      * \file   Allocator.hpp
-                                                                     * \brief
+                                                                     * \brief  Pooled allocator backed by AEGP memory
+                                                                     *handles.
                                                                      *
                                                                      * \author tjerf
                                                                      * \date   April 2024
@@ -11,85 +12,325 @@
 
 #include "AETK/Common/Common.hpp"
 
-// Define a custom allocator class called AEGPCustomAllocator.
-template <typename T> class AEGPCustomAllocator
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace ae
+{
+
+/**
+ * @class ArenaPool
+ * @brief Process-wide slab allocator that sub-allocates from large AEGP memory blocks.
+ *
+ * Memory is reserved from AE in 1 MiB chunks (AEGP_NewMemHandle + AEGP_LockMemHandle, once per chunk) and carved
+ * into power-of-two size classes from 16 to 4096 bytes. Each thread keeps its own free list per size class, so the
+ * common allocate/deallocate pair touches no lock and makes no host call; threads only synchronise when they
+ * refill from, or spill to, the shared per-class lists.
+ *
+ * Requests larger than MaxSmallSize get a dedicated memory handle whose id is stored in a small header in front of
+ * the returned pointer. Before the plugin's suites are initialised, chunks and large blocks fall back to
+ * ::operator new.
+ *
+ * Chunks are kept for the lifetime of the process; freed blocks are recycled, not returned to AE.
+ */
+class ArenaPool
 {
   public:
-    // Define type aliases for the allocator traits.
-    using value_type = T;
-    using pointer = T *;
-    using size_type = size_t;
+    static constexpr std::size_t Alignment = 16;
+    static constexpr std::size_t MinSizeShift = 4; // 16 bytes
+    static constexpr std::size_t ClassCount = 9;   // 16 .. 4096
+    static constexpr std::size_t MaxSmallSize = std::size_t(1) << (MinSizeShift + ClassCount - 1);
+    static constexpr std::size_t ChunkSize = std::size_t(1) << 20;
+    static constexpr std::size_t BatchSize = 32; // blocks moved between a thread cache and the shared lists
 
-    // Define a default constructor for the allocator.
-    AEGPCustomAllocator() noexcept {}
+    /**
+     * @brief Gets the pool. It is intentionally never destroyed, so thread caches can return blocks during
+     * static destruction.
+     */
+    static ArenaPool &GetInstance()
+    {
+        static ArenaPool *pool = new ArenaPool();
+        return *pool;
+    }
 
-    // Define a copy constructor for the allocator.
-    template <typename U> AEGPCustomAllocator(const AEGPCustomAllocator<U> &) noexcept {}
+    void *allocate(std::size_t bytes)
+    {
+        if (bytes > MaxSmallSize)
+        {
+            return allocateLarge(bytes);
+        }
+        const std::size_t sizeClass = classFor(bytes);
+        ThreadCache &cache = threadCache();
+        if (!cache.heads[sizeClass])
+        {
+            refill(cache, sizeClass);
+        }
+        FreeBlock *block = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block->next;
+        --cache.counts[sizeClass];
+        return block;
+    }
 
-    // Define the allocate function, which is used to allocate memory.
-    pointer allocate(size_type n)
+    void deallocate(void *ptr, std::size_t bytes) noexcept
     {
-        // Calculate the size of the memory to be allocated.
-        size_t size = n * sizeof(T);
+        if (!ptr)
+        {
+            return;
+        }
+        if (bytes > MaxSmallSize)
+        {
+            deallocateLarge(ptr);
+            return;
+        }
+        const std::size_t sizeClass = classFor(bytes);
+        ThreadCache &cache = threadCache();
+        auto *block = static_cast<FreeBlock *>(ptr);
+        block->next = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block;
+        if (++cache.counts[sizeClass] > 2 * BatchSize)
+        {
+            spill(cache, sizeClass, BatchSize);
+        }
+    }
+
+    /**
+     * @brief Number of chunks reserved so far.
+     */
+    std::size_t chunkCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_chunkMutex);
+        return m_chunkCount;
+    }
+
+  private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
 
-        // Explicitly handle the conversion, adding a check to ensure no data loss.
-        if (size > (std::numeric_limits<AEGP_MemSize>::max)())
+    struct CentralList
+    {
+        std::mutex mutex;
+        FreeBlock *head = nullptr;
+    };
+
+    struct ThreadCache
+    {
+        FreeBlock *heads[ClassCount] = {};
+        std::size_t counts[ClassCount] = {};
+
+        ~ThreadCache()
         {
-            throw std::bad_alloc(); // Or any other mechanism to signal the error
+            auto &pool = ArenaPool::GetInstance();
+            for (std::size_t sizeClass = 0; sizeClass < ClassCount; ++sizeClass)
+            {
+                pool.spill(*this, sizeClass, counts[sizeClass]);
+            }
         }
+    };
 
-        AEGP_MemHandle memHandle = nullptr;
-        auto &suiteManager = SuiteManager::GetInstance();
-        auto *pluginID = suiteManager.GetPluginID();
+    struct LargeHeader
+    {
+        AEGP_MemHandle handle;
+    };
+    static constexpr std::size_t LargeHeaderSize = (sizeof(LargeHeader) + Alignment - 1) & ~(Alignment - 1);
 
-        // Use static_cast to convert size to AEGP_MemSize now that we've checked
-        // for overflow.
-        AEGP_MemSize safeSize = static_cast<AEGP_MemSize>(size);
+    ArenaPool() = default;
 
-        suiteManager.GetSuiteHandler().MemorySuite1()->AEGP_NewMemHandle(*pluginID, "Custom Allocator Memory", safeSize,
-                                                                         AEGP_MemFlag_CLEAR, &memHandle);
+    static std::size_t classFor(std::size_t bytes)
+    {
+        std::size_t sizeClass = 0;
+        std::size_t size = std::size_t(1) << MinSizeShift;
+        while (size < bytes)
+        {
+            size <<= 1;
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+    static std::size_t classSize(std::size_t sizeClass) { return std::size_t(1) << (MinSizeShift + sizeClass); }
+
+    static ThreadCache &threadCache()
+    {
+        thread_local ThreadCache cache;
+        return cache;
+    }
 
-        if (!memHandle)
+    void refill(ThreadCache &cache, std::size_t sizeClass)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_central[sizeClass].mutex);
+            FreeBlock *&head = m_central[sizeClass].head;
+            while (head && cache.counts[sizeClass] < BatchSize)
+            {
+                FreeBlock *block = head;
+                head = block->next;
+                block->next = cache.heads[sizeClass];
+                cache.heads[sizeClass] = block;
+                ++cache.counts[sizeClass];
+            }
+        }
+        if (cache.heads[sizeClass])
         {
-            throw std::exception("Failed to allocate memory handle.");
+            return;
         }
 
-        void *ptr = nullptr;
-        A_Err err = suiteManager.GetSuiteHandler().MemorySuite1()->AEGP_LockMemHandle(memHandle, &ptr);
-        if (err != A_Err_NONE || !ptr)
+        // Nothing to recycle: carve a fresh batch from the current chunk.
+        const std::size_t size = classSize(sizeClass);
+        std::lock_guard<std::mutex> lock(m_chunkMutex);
+        for (std::size_t i = 0; i < BatchSize; ++i)
         {
-            suiteManager.GetSuiteHandler().MemorySuite1()->AEGP_FreeMemHandle(memHandle);
-            throw std::exception("Failed to lock memory handle.");
+            if (static_cast<std::size_t>(m_chunkEnd - m_chunkCursor) < size)
+            {
+                if (i > 0)
+                {
+                    break; // hand out what we have; the next refill starts a new chunk
+                }
+                newChunk();
+            }
+            auto *block = reinterpret_cast<FreeBlock *>(m_chunkCursor);
+            m_chunkCursor += size;
+            block->next = cache.heads[sizeClass];
+            cache.heads[sizeClass] = block;
+            ++cache.counts[sizeClass];
         }
+    }
 
-        memHandleMap_[static_cast<pointer>(ptr)] = memHandle;
-        return static_cast<pointer>(ptr);
+    void spill(ThreadCache &cache, std::size_t sizeClass, std::size_t count) noexcept
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        FreeBlock *first = cache.heads[sizeClass];
+        FreeBlock *last = first;
+        for (std::size_t i = 1; i < count && last->next; ++i)
+        {
+            last = last->next;
+        }
+        cache.heads[sizeClass] = last->next;
+        cache.counts[sizeClass] -= (std::min)(count, cache.counts[sizeClass]);
+
+        std::lock_guard<std::mutex> lock(m_central[sizeClass].mutex);
+        last->next = m_central[sizeClass].head;
+        m_central[sizeClass].head = first;
     }
 
-    // Define the deallocate function, which is used to deallocate memory.
-    void deallocate(pointer p, size_type n)
+    // Called with m_chunkMutex held.
+    void newChunk()
+    {
+        AEGP_MemHandle handle = nullptr;
+        char *base = static_cast<char *>(acquire(ChunkSize + Alignment, handle));
+        auto address = reinterpret_cast<std::uintptr_t>(base);
+        m_chunkCursor = base + ((Alignment - address % Alignment) % Alignment);
+        m_chunkEnd = base + ChunkSize + Alignment;
+        ++m_chunkCount;
+    }
+
+    void *allocateLarge(std::size_t bytes)
+    {
+        if (bytes > (std::numeric_limits<std::size_t>::max)() - LargeHeaderSize)
+        {
+            throw std::bad_alloc();
+        }
+        AEGP_MemHandle handle = nullptr;
+        char *base = static_cast<char *>(acquire(bytes + LargeHeaderSize, handle));
+        reinterpret_cast<LargeHeader *>(base)->handle = handle;
+        return base + LargeHeaderSize;
+    }
+
+    void deallocateLarge(void *ptr) noexcept
     {
-        // Find the memory handle associated with the pointer in the memHandleMap.
-        auto it = memHandleMap_.find(p);
+        char *base = static_cast<char *>(ptr) - LargeHeaderSize;
+        AEGP_MemHandle handle = reinterpret_cast<LargeHeader *>(base)->handle;
+        if (handle)
+        {
+            auto *memorySuite = SuiteManager::GetInstance().GetSuiteHandler().MemorySuite1();
+            memorySuite->AEGP_UnlockMemHandle(handle);
+            memorySuite->AEGP_FreeMemHandle(handle);
+        }
+        else
+        {
+            ::operator delete(base);
+        }
+    }
+
+    /**
+     * @brief Gets a locked block of memory from AE, or from the C++ heap if the suites are not available yet.
+     */
+    static void *acquire(std::size_t bytes, AEGP_MemHandle &handle)
+    {
+        handle = nullptr;
+        auto &suiteManager = SuiteManager::GetInstance();
+        auto *pluginID = suiteManager.GetPluginID();
+        if (!pluginID)
+        {
+            return ::operator new(bytes);
+        }
+        if (bytes > static_cast<std::size_t>((std::numeric_limits<AEGP_MemSize>::max)()))
+        {
+            throw std::bad_alloc();
+        }
 
-        // Check if the memory handle is found.
-        if (it != memHandleMap_.end())
+        auto *memorySuite = suiteManager.GetSuiteHandler().MemorySuite1();
+        if (memorySuite->AEGP_NewMemHandle(*pluginID, "AETK Arena", static_cast<AEGP_MemSize>(bytes),
+                                           AEGP_MemFlag_NONE, &handle) != A_Err_NONE ||
+            !handle)
+        {
+            throw std::bad_alloc();
+        }
+        void *ptr = nullptr;
+        if (memorySuite->AEGP_LockMemHandle(handle, &ptr) != A_Err_NONE || !ptr)
         {
-            // Get an instance of the SuiteManager.
-            auto &suiteManager = SuiteManager::GetInstance();
+            memorySuite->AEGP_FreeMemHandle(handle);
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    CentralList m_central[ClassCount];
+    mutable std::mutex m_chunkMutex;
+    char *m_chunkCursor = nullptr;
+    char *m_chunkEnd = nullptr;
+    std::size_t m_chunkCount = 0;
+};
+
+} // namespace ae
+
+// Define a custom allocator class called AEGPCustomAllocator.
+// It is stateless: every instance (and every rebound copy) shares ae::ArenaPool, so memory allocated through one
+// copy can always be released through another.
+template <typename T> class AEGPCustomAllocator
+{
+  public:
+    // Define type aliases for the allocator traits.
+    using value_type = T;
+    using pointer = T *;
+    using size_type = size_t;
 
-            // Use the AEGP Memory Suite functions AEGP_UnlockMemHandle and
-            // AEGP_FreeMemHandle to unlock and free the memory handle.
-            suiteManager.GetSuiteHandler().MemorySuite1()->AEGP_UnlockMemHandle(it->second);
-            suiteManager.GetSuiteHandler().MemorySuite1()->AEGP_FreeMemHandle(it->second);
+    static_assert(alignof(T) <= ae::ArenaPool::Alignment, "AEGPCustomAllocator does not support over-aligned types");
+
+    // Define a default constructor for the allocator.
+    AEGPCustomAllocator() noexcept {}
+
+    // Define a copy constructor for the allocator.
+    template <typename U> AEGPCustomAllocator(const AEGPCustomAllocator<U> &) noexcept {}
 
-            // Remove the memory handle from the memHandleMap.
-            memHandleMap_.erase(it);
+    // Define the allocate function, which is used to allocate memory.
+    pointer allocate(size_type n)
+    {
+        if (n > (std::numeric_limits<size_type>::max)() / sizeof(T))
+        {
+            throw std::bad_alloc();
         }
+        return static_cast<pointer>(ae::ArenaPool::GetInstance().allocate(n * sizeof(T)));
     }
 
-  private:
-    std::unordered_map<pointer, AEGP_MemHandle> memHandleMap_; // Store the memory handles in an unordered_map.
+    // Define the deallocate function, which is used to deallocate memory.
+    void deallocate(pointer p, size_type n) noexcept { ae::ArenaPool::GetInstance().deallocate(p, n * sizeof(T)); }
 };
 
 // Define the equality operator for two AEGPCustomAllocator objects.
@@ -3,6 +3,8 @@
 #define PYFX_HPP
 // #define TK_INTERNAL
 #include "AETK/AEGP/Core/Suites.hpp" /* Suite Wrappers For After Effects*/
+#include "AETK/AEGP/Util/ImageView.hpp"
+#include "AETK/AEGP/Util/ProjectIndex.hpp"
 
 #include <Python.h>
 #include <pybind11/embed.h>
@@ -12,23 +14,18 @@
 
 namespace py = pybind11;
 
-template <typename T> inline void bind_handle_wrapper(py::module &m, const std::string &typestr)
+template <typename Class> inline void bind_handle_wrapper(py::module &m, const std::string &typestr)
 {
-    using Class = HandleWrapper<T>;
     using ClassPtr = std::shared_ptr<Class>;
 
     std::string wrapperName = typestr;
     // remove "H" from the end of the type string
     std::string ptrName = wrapperName.substr(0, wrapperName.size() - 1) + "Ptr";
 
-    // Bind HandleWrapper
-    py::class_<HandleWrapper<T>, std::shared_ptr<HandleWrapper<T>>>(m, wrapperName.c_str())
-        .def("__del__", [](HandleWrapper<T> &self) {
-            // Custom cleanup logic here
-            self.~HandleWrapper();
-        });
+    // Bind the handle; the shared_ptr holder disposes it (if owned) when the last reference goes away.
+    py::class_<Class, std::shared_ptr<Class>>(m, wrapperName.c_str());
 
-    // Bind shared_ptr<HandleWrapper>
+    // Bind shared_ptr<Handle>
     py::class_<ClassPtr>(m, ptrName.c_str());
 }
 
@@ -45,6 +42,40 @@ inline void bindStreamValue2(py::module &m)
   //  py::class_<ClassPtr>(m, "StreamValue2Ptr");
 }
 
+// Exposes a view through the buffer protocol as a (height, width, 4) ARGB array that shares the world's pixels.
+template <typename Pixel> inline void bind_image_view(py::module &m, const char *name)
+{
+    using View = ae::ImageView<Pixel>;
+    using Channel = typename View::Channel;
+
+    py::class_<View>(m, name, py::buffer_protocol())
+        .def_buffer([](View &view) -> py::buffer_info {
+            const std::vector<py::ssize_t> shape = {view.height(), view.width(), 4};
+            const std::vector<py::ssize_t> strides = {view.rowBytes(), py::ssize_t(sizeof(Pixel)),
+                                                      py::ssize_t(sizeof(Channel))};
+            return py::buffer_info(view.data(), sizeof(Channel), py::format_descriptor<Channel>::format(), 3, shape,
+                                   strides);
+        })
+        .def_property_readonly("width", &View::width)
+        .def_property_readonly("height", &View::height)
+        .def_property_readonly("rowBytes", &View::rowBytes)
+        .def_property_readonly("bitDepth", [](const View &) { return View::BitDepth; })
+        .def("subview", &View::subview, py::keep_alive<0, 1>());
+}
+
+inline void bind_image_views(py::module &m)
+{
+    bind_image_view<PF_Pixel8>(m, "ImageView8");
+    bind_image_view<PF_Pixel16>(m, "ImageView16");
+    bind_image_view<PF_PixelFloat>(m, "ImageViewFloat");
+
+    // The view keeps the world alive; numpy.asarray(view) does not copy.
+    m.def(
+        "viewWorld",
+        [](WorldPtr world) { return ae::visit_world(world, [](auto view) { return py::cast(view); }); },
+        py::keep_alive<0, 1>());
+}
+
 inline void bind_mem_flag(py::module &m)
 {
     py::enum_<MemFlag>(m, "MemFlag")
@@ -1015,12 +1046,33 @@ inline void bind_time(py::module &m)
         .def(py::init<A_Time>())
         .def(py::init<double>())
         .def(py::init<int>())
+        .def(py::init<double, const ae::TimeBase &>())
+        .def(py::init<int, const ae::TimeBase &>())
         .def("toTime", &Time::toTime)
         .def("toSeconds", &Time::toSeconds)
-        .def("toFrames", &Time::toFrames)
+        .def("toFrames", py::overload_cast<>(&Time::toFrames, py::const_))
+        .def("toFrames", py::overload_cast<const ae::TimeBase &>(&Time::toFrames, py::const_))
         .def("toAEGP", &Time::toAEGP);
 }
 
+inline void bind_time_base(py::module &m)
+{
+    py::class_<ae::TimeBase>(m, "TimeBase")
+        .def(py::init<>())
+        .def(py::init<A_long, A_u_long>())
+        .def_static("fromFrameRate", &ae::TimeBase::fromFrameRate, py::arg("numerator"), py::arg("denominator") = 1)
+        .def_static("fromComp", [](CompPtr comp) { return ae::TimeBase::fromComp(comp->get()); })
+        .def_static("fromLayer", [](LayerPtr layer) { return ae::TimeBase::fromLayer(layer->get()); })
+        .def_static("mostRecent", &ae::TimeBase::mostRecent)
+        .def("frameRate", &ae::TimeBase::frameRate)
+        .def("frameDuration", [](const ae::TimeBase &self) { return Time(self.frameDuration()); })
+        .def("framesToTime", [](const ae::TimeBase &self, A_long frames) { return Time(self.framesToTime(frames)); })
+        .def("timeToFrames", [](const ae::TimeBase &self, const Time &time) { return self.timeToFrames(time.value); })
+        .def("secondsToTime",
+             [](const ae::TimeBase &self, double seconds) { return Time(self.secondsToTime(seconds)); })
+        .def("secondsToFrames", &ae::TimeBase::secondsToFrames);
+}
+
 inline void bind_ratio(py::module &m)
 {
     py::class_<Ratio>(m, "Ratio")
@@ -1243,6 +1295,41 @@ inline void bind_item_suite(py::module &m)
         .def("GetItemViewPlaybackTime", &ItemSuite::GetItemViewPlaybackTime);
 }
 
+inline void bind_project_index(py::module &m)
+{
+    using ae::ProjectIndex;
+    auto toItems = [](const ProjectIndex &index, const std::vector<std::size_t> &indexes) {
+        std::vector<ItemPtr> items;
+        items.reserve(indexes.size());
+        for (auto i : indexes)
+        {
+            items.push_back(ProjectIndex::itemPtr(index.entry(i)));
+        }
+        return items;
+    };
+
+    py::class_<ProjectIndex, std::shared_ptr<ProjectIndex>>(m, "ProjectIndex")
+        .def_static("build", &ProjectIndex::build, py::arg("projectIndex") = 0)
+        .def("__len__", &ProjectIndex::size)
+        .def("root", [](const ProjectIndex &self) { return makeItemPtr(self.root()); })
+        .def("children",
+             [toItems](const ProjectIndex &self, ItemPtr folder) {
+                 return toItems(self, self.children(folder ? folder->get() : self.root()));
+             })
+        .def("findByName",
+             [toItems](const ProjectIndex &self, const std::string &name) { return toItems(self, self.findByName(name)); })
+        .def("ofType", [toItems](const ProjectIndex &self, ItemType type) { return toItems(self, self.ofType(type)); })
+        .def("findById",
+             [](const ProjectIndex &self, A_long id) -> ItemPtr {
+                 auto entry = self.findById(id);
+                 return entry ? ProjectIndex::itemPtr(*entry) : nullptr;
+             })
+        .def("getItemType", [](const ProjectIndex &self, ItemPtr item) {
+            auto entry = item ? self.find(item->get()) : nullptr;
+            return entry ? entry->type : ItemType::NONE;
+        });
+}
+
 inline void bind_comp_suite(py::module &m)
 {
     py::class_<CompSuite>(m, "CompSuite")
@@ -1655,38 +1742,39 @@ PYBIND11_EMBEDDED_MODULE(PyFx, m)
 {
     m.doc() = "Python bindings for After Effects SDK";
 
-    bind_handle_wrapper<AEGP_ProjectH>(m, "ProjectPtr");
-    bind_handle_wrapper<AEGP_ItemH>(m, "ItemPtr");
-    bind_handle_wrapper<AEGP_CompH>(m, "CompPtr");
-    bind_handle_wrapper<AEGP_FootageH>(m, "FootagePtr");
-    bind_handle_wrapper<AEGP_LayerH>(m, "LayerPtr");
-    bind_handle_wrapper<AEGP_EffectRefH>(m, "EffectRefPtr");
-    bind_handle_wrapper<AEGP_MaskRefH>(m, "MaskRefPtr");
-    bind_handle_wrapper<AEGP_StreamRefH>(m, "StreamRefPtr");
-    bind_handle_wrapper<AEGP_RenderLayerContextH>(m, "RenderLayerContextPtr");
-    bind_handle_wrapper<AEGP_PersistentBlobH>(m, "PersistentBlobPtr");
-    bind_handle_wrapper<AEGP_MaskOutlineValH>(m, "MaskOutlineValPtr");
-    bind_handle_wrapper<AEGP_CollectionH>(m, "CollectionPtr");
-    bind_handle_wrapper<AEGP_Collection2H>(m, "Collection2Ptr");
+    bind_handle_wrapper<ProjectH>(m, "ProjectPtr");
+    bind_handle_wrapper<ItemH>(m, "ItemPtr");
+    bind_handle_wrapper<CompH>(m, "CompPtr");
+    bind_handle_wrapper<FootageH>(m, "FootagePtr");
+    bind_handle_wrapper<LayerH>(m, "LayerPtr");
+    bind_handle_wrapper<EffectRefH>(m, "EffectRefPtr");
+    bind_handle_wrapper<MaskRefH>(m, "MaskRefPtr");
+    bind_handle_wrapper<StreamRefH>(m, "StreamRefPtr");
+    bind_handle_wrapper<RenderLayerContextH>(m, "RenderLayerContextPtr");
+    bind_handle_wrapper<PersistentBlobH>(m, "PersistentBlobPtr");
+    bind_handle_wrapper<MaskOutlineValH>(m, "MaskOutlineValPtr");
+    bind_handle_wrapper<CollectionH>(m, "CollectionPtr");
+    bind_handle_wrapper<Collection2H>(m, "Collection2Ptr");
     // bind_handle_wrapper<SoundDataH>(m, "SoundDataPtr");
-    bind_handle_wrapper<AEGP_AddKeyframesInfoH>(m, "AddKeyframesInfoPtr");
-    bind_handle_wrapper<AEGP_RenderReceiptH>(m, "RenderReceiptPtr");
-    bind_handle_wrapper<AEGP_WorldH>(m, "WorldPtr");
-    bind_handle_wrapper<AEGP_RenderOptionsH>(m, "RenderOptionsPtr");
-    bind_handle_wrapper<AEGP_LayerRenderOptionsH>(m, "LayerRenderOptionsPtr");
-    bind_handle_wrapper<AEGP_FrameReceiptH>(m, "FrameReceiptPtr");
-    bind_handle_wrapper<AEGP_RQItemRefH>(m, "RQItemRefPtr");
-    bind_handle_wrapper<AEGP_OutputModuleRefH>(m, "OutputModuleRefPtr");
-    bind_handle_wrapper<AEGP_TextDocumentH>(m, "TextDocumentPtr");
-    bind_handle_wrapper<AEGP_MarkerValP>(m, "MarkerValPtr");
-    bind_handle_wrapper<AEGP_TextOutlinesH>(m, "TextOutlinesPtr");
-    bind_handle_wrapper<AEGP_PlatformWorldH>(m, "PlatformWorldPtr");
-    bind_handle_wrapper<AEGP_ItemViewP>(m, "ItemViewPtr");
+    bind_handle_wrapper<AddKeyframesInfoH>(m, "AddKeyframesInfoPtr");
+    bind_handle_wrapper<RenderReceiptH>(m, "RenderReceiptPtr");
+    bind_handle_wrapper<WorldH>(m, "WorldPtr");
+    bind_handle_wrapper<RenderOptionsH>(m, "RenderOptionsPtr");
+    bind_handle_wrapper<LayerRenderOptionsH>(m, "LayerRenderOptionsPtr");
+    bind_handle_wrapper<FrameReceiptH>(m, "FrameReceiptPtr");
+    bind_handle_wrapper<RQItemRefH>(m, "RQItemRefPtr");
+    bind_handle_wrapper<OutputModuleRefH>(m, "OutputModuleRefPtr");
+    bind_handle_wrapper<TextDocumentH>(m, "TextDocumentPtr");
+    bind_handle_wrapper<MarkerValP>(m, "MarkerValPtr");
+    bind_handle_wrapper<TextOutlinesH>(m, "TextOutlinesPtr");
+    bind_handle_wrapper<PlatformWorldH>(m, "PlatformWorldPtr");
+    bind_handle_wrapper<ItemViewP>(m, "ItemViewPtr");
     // bind_handle_wrapper<ColorProfileP>(m, "ColorProfilePtr");
     // bind_handle_wrapper<ConstColorProfileP>(m, "ConstColorProfilePtr");
     // bind_handle_wrapper<TimeStamp>(m, "TimeStampPtr");
     // bind_handle_wrapper<MemHandle>(m, "MemHandlePtr");
     bindStreamValue2(m);
+    bind_image_views(m);
     bind_color_val(m);
     bind_mem_flag(m);
     bind_platform(m);
@@ -1767,6 +1855,7 @@ PYBIND11_EMBEDDED_MODULE(PyFx, m)
     bind_loop_behavior(m);
     bind_footage_layer_key(m);
     bind_file_sequence_import_options(m);
+    bind_time_base(m);
     bind_time(m);
     bind_ratio(m);
     bind_float_point(m);
@@ -1780,6 +1869,7 @@ PYBIND11_EMBEDDED_MODULE(PyFx, m)
     bind_text_document_val(m);
     bind_proj_suite(m);
     bind_item_suite(m);
+    bind_project_index(m);
     // bind_sound_data_suite(m);
     bind_comp_suite(m);
     bind_layer_suite(m);
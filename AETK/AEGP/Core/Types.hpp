@@ -195,6 +195,94 @@ template <typename HandleType> class HandleWrapper
     void removeDeleter() { deleter = nullptr; }
 };
 
+/**
+ * @brief Owning wrapper for an AEGP handle with a compile-time deleter.
+ *
+ * Unlike HandleWrapper, the deleter is a template argument rather than a std::function, so a Handle is just the
+ * raw handle plus an ownership flag. `std::make_shared<Handle<...>>` therefore costs a single allocation (control
+ * block and handle together) and disposal is a direct call.
+ *
+ * @tparam HandleType The AEGP handle type.
+ * @tparam Deleter The dispose function, or nullptr for handles AE owns.
+ */
+template <typename HandleType, void (*Deleter)(HandleType) = nullptr> class Handle
+{
+  private:
+    HandleType handle;
+    bool owned;
+
+  public:
+    Handle() : handle(nullptr), owned(false) {}
+    /**
+     * @param handle The raw handle.
+     * @param owned Whether the handle is disposed with Deleter when this object dies.
+     */
+    explicit Handle(HandleType handle, bool owned = Deleter != nullptr) : handle(handle), owned(owned) {}
+
+    ~Handle() { dispose(); }
+
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+
+    Handle(Handle &&other) noexcept : handle(other.handle), owned(other.owned)
+    {
+        other.handle = nullptr;
+        other.owned = false;
+    }
+
+    Handle &operator=(Handle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            dispose();
+            handle = other.handle;
+            owned = other.owned;
+            other.handle = nullptr;
+            other.owned = false;
+        }
+        return *this;
+    }
+
+    HandleType &get() { return handle; }
+    const HandleType &get() const { return handle; }
+    operator HandleType() const { return handle; }
+    HandleType operator->() const { return handle; }
+    const HandleType &operator*() const { return handle; }
+
+    operator bool() const { return handle != nullptr; }
+
+    void reset(HandleType newHandle = nullptr)
+    {
+        dispose();
+        handle = newHandle;
+    }
+
+    void swap(Handle &other)
+    {
+        std::swap(handle, other.handle);
+        std::swap(owned, other.owned);
+    }
+
+    void release() { handle = nullptr; }
+
+    // remove deleter
+    void removeDeleter() { owned = false; }
+
+    bool ownsHandle() const { return owned; }
+
+  private:
+    void dispose()
+    {
+        if constexpr (Deleter != nullptr)
+        {
+            if (owned && handle)
+            {
+                Deleter(handle);
+            }
+        }
+    }
+};
+
 inline void disposeStream(AEGP_StreamRefH stream)
 {
     SuiteManager::GetInstance().GetSuiteHandler().StreamSuite2()->AEGP_DisposeStream(stream);
@@ -275,38 +363,38 @@ inline void disposeSoundData(AEGP_SoundDataH soundData)
     SuiteManager::GetInstance().GetSuiteHandler().SoundDataSuite1()->AEGP_DisposeSoundData(soundData);
 }
 
-using ProjectH = HandleWrapper<AEGP_ProjectH>;
-using ItemH = HandleWrapper<AEGP_ItemH>;
-using CompH = HandleWrapper<AEGP_CompH>;
-using FootageH = HandleWrapper<AEGP_FootageH>;
-using LayerH = HandleWrapper<AEGP_LayerH>;
-using EffectRefH = HandleWrapper<AEGP_EffectRefH>;
-using MaskRefH = HandleWrapper<AEGP_MaskRefH>;
-using StreamRefH = HandleWrapper<AEGP_StreamRefH>;
-using RenderLayerContextH = HandleWrapper<AEGP_RenderLayerContextH>;
-using PersistentBlobH = HandleWrapper<AEGP_PersistentBlobH>;
-using MaskOutlineValH = HandleWrapper<AEGP_MaskOutlineValH>;
-using CollectionH = HandleWrapper<AEGP_CollectionH>;
-using Collection2H = HandleWrapper<AEGP_Collection2H>;
-using SoundDataH = HandleWrapper<AEGP_SoundDataH>;
-using AddKeyframesInfoH = HandleWrapper<AEGP_AddKeyframesInfoH>;
-using RenderReceiptH = HandleWrapper<AEGP_RenderReceiptH>;
-using WorldH = HandleWrapper<AEGP_WorldH>;
-using RenderOptionsH = HandleWrapper<AEGP_RenderOptionsH>;
-using LayerRenderOptionsH = HandleWrapper<AEGP_LayerRenderOptionsH>;
-using FrameReceiptH = HandleWrapper<AEGP_FrameReceiptH>;
-using RQItemRefH = HandleWrapper<AEGP_RQItemRefH>;
-using OutputModuleRefH = HandleWrapper<AEGP_OutputModuleRefH>;
-using TextDocumentH = HandleWrapper<AEGP_TextDocumentH>;
-using MarkerValP = HandleWrapper<AEGP_MarkerValP>;
-using TextOutlinesH = HandleWrapper<AEGP_TextOutlinesH>;
-using PlatformWorldH = HandleWrapper<AEGP_PlatformWorldH>;
-using ItemViewP = HandleWrapper<AEGP_ItemViewP>;
-using ColorProfileP = HandleWrapper<AEGP_ColorProfileP>;
-using ConstColorProfileP = HandleWrapper<AEGP_ConstColorProfileP>;
+using ProjectH = Handle<AEGP_ProjectH>;
+using ItemH = Handle<AEGP_ItemH>;
+using CompH = Handle<AEGP_CompH>;
+using FootageH = Handle<AEGP_FootageH, &disposeFootage>;
+using LayerH = Handle<AEGP_LayerH>;
+using EffectRefH = Handle<AEGP_EffectRefH, &disposeEffect>;
+using MaskRefH = Handle<AEGP_MaskRefH, &disposeMask>;
+using StreamRefH = Handle<AEGP_StreamRefH, &disposeStream>;
+using RenderLayerContextH = Handle<AEGP_RenderLayerContextH>;
+using PersistentBlobH = Handle<AEGP_PersistentBlobH>;
+using MaskOutlineValH = Handle<AEGP_MaskOutlineValH>;
+using CollectionH = Handle<AEGP_CollectionH>;
+using Collection2H = Handle<AEGP_Collection2H, &disposeCollection>;
+using SoundDataH = Handle<AEGP_SoundDataH, &disposeSoundData>;
+using AddKeyframesInfoH = Handle<AEGP_AddKeyframesInfoH>;
+using RenderReceiptH = Handle<AEGP_RenderReceiptH>;
+using WorldH = Handle<AEGP_WorldH, &disposeWorld>;
+using RenderOptionsH = Handle<AEGP_RenderOptionsH, &disposeRenderOptions>;
+using LayerRenderOptionsH = Handle<AEGP_LayerRenderOptionsH, &disposeLayerRenderOptions>;
+using FrameReceiptH = Handle<AEGP_FrameReceiptH, &disposeFrameReceipt>;
+using RQItemRefH = Handle<AEGP_RQItemRefH>;
+using OutputModuleRefH = Handle<AEGP_OutputModuleRefH>;
+using TextDocumentH = Handle<AEGP_TextDocumentH>;
+using MarkerValP = Handle<AEGP_MarkerValP, &disposeMarker>;
+using TextOutlinesH = Handle<AEGP_TextOutlinesH, &disposeTextOutline>;
+using PlatformWorldH = Handle<AEGP_PlatformWorldH, &disposePlatform>;
+using ItemViewP = Handle<AEGP_ItemViewP>;
+using ColorProfileP = Handle<AEGP_ColorProfileP>;
+using ConstColorProfileP = Handle<AEGP_ConstColorProfileP>;
 using TimeStamp = HandleWrapper<AEGP_TimeStamp>;
 // using StreamValue2 = HandleWrapper<AEGP_StreamValue2>;
-using MemHandle = HandleWrapper<AEGP_MemHandle>;
+using MemHandle = Handle<AEGP_MemHandle, &disposeMemHandle>;
 typedef std::shared_ptr<StreamRefH> StreamRefPtr;
 class StreamValue2 : public HandleWrapper<AEGP_StreamValue2>
 {
@@ -389,11 +477,7 @@ inline CompPtr makeCompPtr(AEGP_CompH comp)
 inline FootagePtr makeFootagePtr(AEGP_FootageH footage, bool dispose = true)
 {
     NULLCHECK(footage);
-    if (dispose)
-    {
-        return std::make_shared<FootageH>(footage, disposeFootage);
-    }
-    return std::make_shared<FootageH>(footage);
+    return std::make_shared<FootageH>(footage, dispose);
 }
 
 inline LayerPtr makeLayerPtr(AEGP_LayerH layer)
@@ -405,31 +489,19 @@ inline LayerPtr makeLayerPtr(AEGP_LayerH layer)
 inline EffectRefPtr makeEffectRefPtr(AEGP_EffectRefH effect, bool dispose = true)
 {
     NULLCHECK(effect);
-    if (dispose)
-    {
-        return std::make_shared<EffectRefH>(effect, disposeEffect);
-    }
-    return std::make_shared<EffectRefH>(effect);
+    return std::make_shared<EffectRefH>(effect, dispose);
 }
 
 inline MaskRefPtr makeMaskRefPtr(AEGP_MaskRefH mask, bool dispose = true)
 {
     NULLCHECK(mask);
-    if (dispose)
-    {
-        return std::make_shared<MaskRefH>(mask, disposeMask);
-    }
-    return std::make_shared<MaskRefH>(mask);
+    return std::make_shared<MaskRefH>(mask, dispose);
 }
 
 inline StreamRefPtr makeStreamRefPtr(AEGP_StreamRefH stream, bool dispose = true)
 {
     NULLCHECK(stream);
-    if (dispose)
-    {
-        return std::make_shared<StreamRefH>(stream, disposeStream);
-    }
-    return std::make_shared<StreamRefH>(stream);
+    return std::make_shared<StreamRefH>(stream, dispose);
 }
 
 inline RenderLayerContextPtr makeRenderLayerContextPtr(AEGP_RenderLayerContextH renderLayerContext)
@@ -459,17 +531,13 @@ inline CollectionPtr makeCollectionPtr(AEGP_CollectionH collection)
 inline Collection2Ptr makeCollection2Ptr(AEGP_Collection2H collection)
 {
     NULLCHECK(collection);
-    return std::make_shared<Collection2H>(collection, disposeCollection);
+    return std::make_shared<Collection2H>(collection);
 }
 
 inline SoundDataPtr makeSoundDataPtr(AEGP_SoundDataH soundData, bool dispose = true)
 {
     NULLCHECK(soundData);
-    if (dispose)
-    {
-        return std::make_shared<SoundDataH>(soundData, disposeSoundData);
-    }
-    return std::make_shared<SoundDataH>(soundData);
+    return std::make_shared<SoundDataH>(soundData, dispose);
 }
 
 inline AddKeyframesInfoPtr makeAddKeyframesInfoPtr(AEGP_AddKeyframesInfoH addKeyframesInfo)
@@ -487,37 +555,25 @@ inline RenderReceiptPtr makeRenderReceiptPtr(AEGP_RenderReceiptH renderReceipt)
 inline WorldPtr makeWorldPtr(AEGP_WorldH world, bool dispose = true)
 {
     NULLCHECK(world);
-    if (dispose)
-    {
-        return std::make_shared<WorldH>(world, disposeWorld);
-    }
-    return std::make_shared<WorldH>(world);
+    return std::make_shared<WorldH>(world, dispose);
 }
 
 inline RenderOptionsPtr makeRenderOptionsPtr(AEGP_RenderOptionsH renderOptions, bool dispose = true)
 {
     NULLCHECK(renderOptions);
-    if (dispose)
-    {
-        return std::make_shared<RenderOptionsH>(renderOptions, disposeRenderOptions);
-    }
-    return std::make_shared<RenderOptionsH>(renderOptions);
+    return std::make_shared<RenderOptionsH>(renderOptions, dispose);
 }
 
 inline LayerRenderOptionsPtr makeLayerRenderOptionsPtr(AEGP_LayerRenderOptionsH layerRenderOptions, bool dispose = true)
 {
     NULLCHECK(layerRenderOptions);
-    if (dispose)
-    {
-        return std::make_shared<LayerRenderOptionsH>(layerRenderOptions, disposeLayerRenderOptions);
-    }
-    return std::make_shared<LayerRenderOptionsH>(layerRenderOptions);
+    return std::make_shared<LayerRenderOptionsH>(layerRenderOptions, dispose);
 }
 
 inline FrameReceiptPtr makeFrameReceiptPtr(AEGP_FrameReceiptH frameReceipt)
 {
     NULLCHECK(frameReceipt);
-    return std::make_shared<FrameReceiptH>(frameReceipt);
+    return std::make_shared<FrameReceiptH>(frameReceipt, false); // checked in by RenderSuite, not on release
 }
 
 inline RQItemRefPtr makeRQItemRefPtr(AEGP_RQItemRefH rqItemRef)
@@ -541,27 +597,19 @@ inline TextDocumentPtr makeTextDocumentPtr(AEGP_TextDocumentH textDocument)
 inline MarkerValPtr makeMarkerValPtr(AEGP_MarkerValP markerVal, bool dispose = true)
 {
     NULLCHECK(markerVal);
-    if (dispose)
-    {
-        return std::make_shared<MarkerValP>(markerVal, disposeMarker);
-    }
-    return std::make_shared<MarkerValP>(markerVal);
+    return std::make_shared<MarkerValP>(markerVal, dispose);
 }
 
 inline TextOutlinesPtr makeTextOutlinesPtr(AEGP_TextOutlinesH textOutlines, bool dispose = true)
 {
     NULLCHECK(textOutlines);
-    if (dispose)
-    {
-        return std::make_shared<TextOutlinesH>(textOutlines, disposeTextOutline);
-    }
-    return std::make_shared<TextOutlinesH>(textOutlines);
+    return std::make_shared<TextOutlinesH>(textOutlines, dispose);
 }
 
 inline PlatformWorldPtr makePlatformWorldPtr(AEGP_PlatformWorldH platformWorld)
 {
     NULLCHECK(platformWorld);
-    return std::make_shared<PlatformWorldH>(platformWorld);
+    return std::make_shared<PlatformWorldH>(platformWorld, false);
 }
 
 inline ItemViewPtr makeItemViewPtr(AEGP_ItemViewP itemView)
@@ -597,7 +645,7 @@ inline StreamValue2Ptr makeStreamValue2Ptr(AEGP_StreamValue2 streamValue)
 inline MemHandlePtr makeMemHandlePtr(AEGP_MemHandle memHandle)
 {
     NULLCHECK(memHandle);
-    return std::make_shared<MemHandle>(memHandle, disposeMemHandle);
+    return std::make_shared<MemHandle>(memHandle);
 }
 
 /**
@@ -1081,10 +1129,14 @@ class Time
     Time(A_Time time) : value(time) {}
     Time(double seconds) { value = SecondsToTime(seconds); };
     Time(int frames) { value = FramesToTime(frames); };
+    // No host calls: converted with the given comp time base.
+    Time(double seconds, const ae::TimeBase &base) : value(base.secondsToTime(seconds)) {}
+    Time(int frames, const ae::TimeBase &base) : value(base.framesToTime(frames)) {}
 
     A_Time toTime() const { return value; }                   // Added const here
     double toSeconds() const { return TimeToSeconds(value); } // Added const here
     int toFrames() const { return TimeToFrames(value); }      // Added const here
+    int toFrames(const ae::TimeBase &base) const { return base.timeToFrames(value); }
     A_Time toAEGP() const { return value; }                   // Added const here
 
     A_Time value;
@@ -1,5 +1,5 @@
 #include "Utility.hpp"
-#include "Types.hpp"
+#include "Suites.hpp"
 #include "AETK/AEGP/Util/TaskScheduler.hpp"
 
 double TimeToSeconds(const A_Time &time)
@@ -14,40 +14,62 @@ double TimeToSeconds(const A_Time &time)
     return rounded / 100.0;
 } // Will find active comp and convert using frame rate
 
-A_Time SecondsToTime(double seconds)
+namespace ae
+{
+
+TimeBase TimeBase::fromComp(AEGP_CompH comp)
 {
-    auto future = ae::ScheduleOrExecute([seconds]() {
-        AEGP_CompH comp;
-        double frameRate;
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetMostRecentlyUsedComp(&comp);
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetCompFramerate(comp, &frameRate);
-        A_u_long scale = static_cast<A_u_long>(frameRate);
-        return A_Time{static_cast<A_long>(std::round(seconds * scale)), scale};
+    auto future = ScheduleOrExecute([comp]() {
+        A_Time frameDuration{1, 30};
+        AE_CHECK(SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetCompFrameDuration(
+            comp, &frameDuration));
+        return TimeBase(frameDuration);
     });
     return future.get();
 }
 
-int TimeToFrames(const A_Time &time)
+TimeBase TimeBase::fromLayer(AEGP_LayerH layer)
 {
-    auto future = ae::ScheduleOrExecute([time]() {
-        AEGP_CompH comp;
-        double frameRate;
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetMostRecentlyUsedComp(&comp);
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetCompFramerate(comp, &frameRate);
-        return static_cast<int>(std::round(TimeToSeconds(time) * frameRate));
+    auto future = ScheduleOrExecute([layer]() {
+        AEGP_CompH comp = nullptr;
+        A_Time frameDuration{1, 30};
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        AE_CHECK(suites.LayerSuite9()->AEGP_GetLayerParentComp(layer, &comp));
+        AE_CHECK(suites.CompSuite11()->AEGP_GetCompFrameDuration(comp, &frameDuration));
+        return TimeBase(frameDuration);
     });
     return future.get();
 }
 
-A_Time FramesToTime(int frames)
+TimeBase TimeBase::mostRecent()
 {
-    auto future = ae::ScheduleOrExecute([frames]() {
-        AEGP_CompH comp;
-        double frameRate;
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetMostRecentlyUsedComp(&comp);
-        SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetCompFramerate(comp, &frameRate);
-        A_u_long scale = static_cast<A_u_long>(frameRate);
-        return A_Time{frames, scale};
+    auto future = ScheduleOrExecute([]() {
+        AEGP_CompH comp = nullptr;
+        A_Time frameDuration{1, 30};
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        AE_CHECK(suites.CompSuite11()->AEGP_GetMostRecentlyUsedComp(&comp));
+        if (comp)
+        {
+            AE_CHECK(suites.CompSuite11()->AEGP_GetCompFrameDuration(comp, &frameDuration));
+        }
+        return TimeBase(frameDuration);
     });
     return future.get();
-}
\ No newline at end of file
+}
+
+} // namespace ae
+
+A_Time SecondsToTime(double seconds)
+{
+    return ae::TimeBase::mostRecent().secondsToTime(seconds);
+}
+
+int TimeToFrames(const A_Time &time)
+{
+    return ae::TimeBase::mostRecent().timeToFrames(time);
+}
+
+A_Time FramesToTime(int frames)
+{
+    return ae::TimeBase::mostRecent().framesToTime(frames);
+}
@@ -11,18 +11,212 @@
 #include "AETK//Common/Common.hpp"
 #include "AETK/AEGP/Core/Enums.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
 template <class... Ts> struct overloaded : Ts...
 {
     using Ts::operator()...;
 };
 template <class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
+namespace ae
+{
+
+/**
+ * @class TimeBase
+ * @brief A comp's exact frame duration, for converting between seconds, frames and A_Time without host calls.
+ *
+ * The frame duration is kept as the rational AE reports (e.g. 1001/30000 s for 29.97 fps), so conversions are exact
+ * integer math and do not drift. Capture it once per comp (fromComp / fromLayer), then convert as often as needed.
+ * CompClock is an alias for the same type.
+ *
+ * @example
+ * auto clock = ae::TimeBase::fromComp(comp->get());
+ * A_Time t = clock.framesToTime(120);
+ * A_long frame = clock.timeToFrames(t); // 120
+ */
+class TimeBase
+{
+  public:
+    constexpr TimeBase() noexcept = default; // 30 fps
+
+    /**
+     * @brief A time base whose frames last frameValue / frameScale seconds.
+     */
+    constexpr TimeBase(A_long frameValue, A_u_long frameScale) noexcept
+        : m_value(frameValue > 0 ? frameValue : 1), m_scale(frameScale > 0 ? frameScale : 1)
+    {
+    }
+
+    constexpr explicit TimeBase(const A_Time &frameDuration) noexcept
+        : TimeBase(frameDuration.value, frameDuration.scale)
+    {
+    }
+
+    /**
+     * @brief A time base for a rational frame rate, e.g. fromFrameRate(30000, 1001) for 29.97 fps.
+     */
+    static constexpr TimeBase fromFrameRate(A_u_long numerator, A_long denominator = 1) noexcept
+    {
+        return TimeBase(denominator, numerator);
+    }
+
+    static TimeBase fromComp(AEGP_CompH comp);   // one host call
+    static TimeBase fromLayer(AEGP_LayerH layer); // the layer's parent comp; two host calls
+    static TimeBase mostRecent();                // the most recently used comp; two host calls
+
+    constexpr A_Time frameDuration() const noexcept { return A_Time{m_value, m_scale}; }
+
+    constexpr double frameRate() const noexcept { return static_cast<double>(m_scale) / m_value; }
+
+    constexpr A_Time framesToTime(A_long frames) const noexcept { return A_Time{frames * m_value, m_scale}; }
+
+    /**
+     * @brief The frame nearest to time.
+     */
+    constexpr A_long timeToFrames(const A_Time &time) const noexcept
+    {
+        if (time.scale == 0)
+        {
+            return 0;
+        }
+        // frames = (time.value / time.scale) / (m_value / m_scale)
+        const std::int64_t num = static_cast<std::int64_t>(time.value) * m_scale;
+        const std::int64_t den = static_cast<std::int64_t>(time.scale) * m_value;
+        return static_cast<A_long>(divideRounded(num, den));
+    }
+
+    /**
+     * @brief The frame nearest to a time in seconds.
+     */
+    constexpr A_long secondsToFrames(double seconds) const noexcept
+    {
+        return static_cast<A_long>(roundToInt(seconds * m_scale / m_value));
+    }
+
+    /**
+     * @brief Converts seconds to an A_Time in this time base, on the nearest frame.
+     */
+    constexpr A_Time secondsToTime(double seconds) const noexcept { return framesToTime(secondsToFrames(seconds)); }
+
+    static constexpr double timeToSeconds(const A_Time &time) noexcept
+    {
+        return time.scale == 0 ? 0.0 : static_cast<double>(time.value) / time.scale;
+    }
+
+    /**
+     * @brief Moves time onto the nearest frame boundary, in this time base's scale.
+     */
+    constexpr A_Time snap(const A_Time &time) const noexcept { return framesToTime(timeToFrames(time)); }
+
+    constexpr bool operator==(const TimeBase &other) const noexcept
+    {
+        return static_cast<std::int64_t>(m_value) * other.m_scale ==
+               static_cast<std::int64_t>(other.m_value) * m_scale;
+    }
+    constexpr bool operator!=(const TimeBase &other) const noexcept { return !(*this == other); }
+
+  private:
+    static constexpr std::int64_t roundToInt(double x) noexcept
+    {
+        return x >= 0 ? static_cast<std::int64_t>(x + 0.5) : -static_cast<std::int64_t>(-x + 0.5);
+    }
+
+    // Rounds num / den to the nearest integer, halves away from zero; den > 0.
+    static constexpr std::int64_t divideRounded(std::int64_t num, std::int64_t den) noexcept
+    {
+        return num >= 0 ? (2 * num + den) / (2 * den) : -((-2 * num + den) / (2 * den));
+    }
+
+    A_long m_value = 1;
+    A_u_long m_scale = 30;
+};
+
+using CompClock = TimeBase;
+
+/**
+ * @class LazyTimeBase
+ * @brief A TimeBase that is looked up on first use and then shared.
+ *
+ * A layer and every property resolved from it share one of these, so the comp's frame duration is fetched once per
+ * layer, and only if something converts time.
+ *
+ * The value is kept until InvalidateAll(). ChangeTracker calls it whenever a poll finds a watched item changed, so
+ * with change tracking enabled and the comp watched, a new frame rate is picked up on the next use. Otherwise a
+ * layer keeps the frame rate it first saw; call InvalidateAll() after changing one.
+ */
+class LazyTimeBase
+{
+  public:
+    explicit LazyTimeBase(std::function<TimeBase()> resolve) : m_resolve(std::move(resolve)) {}
+    explicit LazyTimeBase(const TimeBase &value) : m_value(value), m_resolved(true) {}
+
+    TimeBase get()
+    {
+        const std::uint64_t generation = Generation().load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_resolved && (!m_resolve || m_generation == generation))
+            {
+                return m_value;
+            }
+        }
+        // Resolved without holding the lock: the lookup waits for the main thread, which may call get() on this
+        // object meanwhile. Two threads may both resolve; they get the same value.
+        const TimeBase value = m_resolve();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_value = value;
+        m_resolved = true;
+        m_generation = generation;
+        return value;
+    }
+
+    /**
+     * @brief Makes every resolving LazyTimeBase look its value up again on next use.
+     */
+    static void InvalidateAll() { Generation().fetch_add(1, std::memory_order_acq_rel); }
+
+  private:
+    static std::atomic<std::uint64_t> &Generation()
+    {
+        static std::atomic<std::uint64_t> generation{0};
+        return generation;
+    }
+
+    std::mutex m_mutex;
+    std::function<TimeBase()> m_resolve;
+    TimeBase m_value;
+    bool m_resolved = false;
+    std::uint64_t m_generation = 0;
+};
+
+} // namespace ae
+
 double TimeToSeconds(const A_Time &time);
 
+// These use the most recently used comp's frame rate (two host calls each); prefer the ae::TimeBase overloads.
 A_Time SecondsToTime(double seconds);
 
 int TimeToFrames(const A_Time &time);
 
 A_Time FramesToTime(int frames);
 
+inline A_Time SecondsToTime(double seconds, const ae::TimeBase &base)
+{
+    return base.secondsToTime(seconds);
+}
+
+inline int TimeToFrames(const A_Time &time, const ae::TimeBase &base)
+{
+    return base.timeToFrames(time);
+}
+
+inline A_Time FramesToTime(int frames, const ae::TimeBase &base)
+{
+    return base.framesToTime(frames);
+}
+
 #endif // UTILITY_HPP
\ No newline at end of file
@@ -29,6 +29,10 @@ class FootageItem;
 class ItemCollection;
 class Layer;
 class LayerCollection;
+namespace ae
+{
+class ProjectIndex;
+}
 
 /**
  * Item class is a wrapper for AEGP_ItemH, and its associated functions
@@ -100,8 +104,12 @@ class FolderItem : public Item
 
     tk::shared_ptr<ItemCollection> children(); // Returns the children of the folder
 
+    // Lets children() reuse an index built for a parent folder instead of walking the project again.
+    void setProjectIndex(std::shared_ptr<const ae::ProjectIndex> index) { m_index = std::move(index); }
+
     private:
         tk::shared_ptr<ItemCollection> m_children;
+        std::shared_ptr<const ae::ProjectIndex> m_index;
 };
 
 class CompItem : public Item
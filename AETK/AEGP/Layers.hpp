@@ -28,7 +28,8 @@ class CompItem;
 class Layer : public PropertyGroup
 {
   public:
-    Layer(LayerPtr layer) : m_layer(layer), PropertyGroup(DynamicStreamSuite().GetNewStreamRefForLayer(layer)) {}
+    // The layer's root stream is only acquired once a property method needs it (see acquireStream).
+    Layer(LayerPtr layer) : PropertyGroup(), m_layer(layer) { setTimeBaseSource(layerTimeBase(layer)); }
 
     virtual ~Layer() = default;
 
@@ -37,7 +38,13 @@ class Layer : public PropertyGroup
     static tk::shared_ptr<Layer> activeLayer();
 
     LayerPtr getLayer() const { return m_layer; }
-    void setLayer(LayerPtr layer) { m_layer = layer; }
+    void setLayer(LayerPtr layer)
+    {
+        m_layer = layer;
+        resetStream();
+        setTimeBaseSource(layerTimeBase(layer));
+        invalidateCache();
+    }
 
     std::string getName();
     std::string getMatchName();
@@ -101,6 +108,14 @@ class Layer : public PropertyGroup
     tk::shared_ptr<TextDocumentProperty> Text();
 
   protected:
+    StreamRefPtr acquireStream() const override { return DynamicStreamSuite().GetNewStreamRefForLayer(m_layer); }
+
+    // The parent comp's time base, fetched the first time this layer or one of its properties converts time.
+    static std::shared_ptr<ae::LazyTimeBase> layerTimeBase(LayerPtr layer)
+    {
+        return std::make_shared<ae::LazyTimeBase>([layer] { return ae::TimeBase::fromLayer(layer->get()); });
+    }
+
     LayerPtr m_layer;
 };
 
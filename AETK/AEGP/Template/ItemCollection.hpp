@@ -13,6 +13,7 @@
 
 #include "AETK/AEGP/Core/Core.hpp"
 #include "AETK/AEGP/Template/Collection.hpp"
+#include "AETK/AEGP/Util/ProjectIndex.hpp"
 
 class Item;
 class CompItem;
@@ -35,6 +36,11 @@ class ItemCollection : public Collection<tk::shared_ptr<Item>>
   public:
     ItemCollection() = default;
     ItemCollection(tk::shared_ptr<Item> FolderItem) : baseItem(FolderItem) { createCollection(); }
+    ItemCollection(tk::shared_ptr<Item> FolderItem, std::shared_ptr<const ae::ProjectIndex> index)
+        : baseItem(FolderItem), m_index(std::move(index))
+    {
+        createCollection();
+    }
     ItemCollection(tk::vector<tk::shared_ptr<Item>> items) : Collection(items) {}
     ~ItemCollection() = default;
 
@@ -66,6 +72,7 @@ class ItemCollection : public Collection<tk::shared_ptr<Item>>
 
   private:
     tk::shared_ptr<Item> baseItem;
+    std::shared_ptr<const ae::ProjectIndex> m_index; // shared with the folders created from it
 };
 
 #endif // ITEMCOLLECTION_HPP
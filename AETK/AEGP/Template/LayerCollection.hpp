@@ -73,8 +73,19 @@ class LayerCollection : public Collection<tk::shared_ptr<Layer>>
     tk::vector<tk::shared_ptr<Layer>> slice(int start) override;
     tk::vector<tk::shared_ptr<Layer>> slice() override { return m_collection; }
 
+    /**
+     * \brief Reverses the layers in the comp.
+     *
+     * Only the layers that must move are reordered (see sort), in one undo group.
+     */
     void reverse() override;
 
+    /**
+     * \brief Sorts the layers in the comp; compare(a, b) returns true if a belongs above b (as std::sort).
+     *
+     * The sort and the fewest ReorderLayer calls that produce its order run in one main-thread task and one undo
+     * group, so comparators that query AE run inline. Layers outside the collection keep their places.
+     */
     void sort(std::function<bool(tk::shared_ptr<Layer>, tk::shared_ptr<Layer>)> compare);
 
     void createCollection();
@@ -82,6 +93,9 @@ class LayerCollection : public Collection<tk::shared_ptr<Layer>>
     tk::vector<tk::shared_ptr<Layer>> find(const std::function<bool(tk::shared_ptr<Layer>)> &predicate);
 
   protected:
+    // Moves the collection's layers into the order makeTarget returns. makeTarget runs inside the batch.
+    void reorder(const std::function<tk::vector<tk::shared_ptr<Layer>>()> &makeTarget, const std::string &undoName);
+
     CompPtr baseComp;
 };
 
@@ -14,6 +14,7 @@
 #define PLUGIN_HPP
 
 #include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/ChangeTracker.hpp"
 /**
  * @class Command
  * @brief Abstract base class for creating commands within the plugin.
@@ -153,6 +154,8 @@ class Plugin
                                 AEGP_PluginID aegp_plugin_id,      /* >> */
                                 AEGP_GlobalRefcon *global_refconV) /* << */
     {
+        // AE calls the entry point on its main thread; remember it so suite calls made from hooks run inline.
+        ae::TaskScheduler::GetInstance().SetMainThread();
         Plugin *plugin = new T(pica_basicP, aegp_plugin_id, global_refconV);
         plugin->onInit();
         return A_Err_NONE;
@@ -207,6 +210,28 @@ class Plugin
     {
         if (instance)
         {
+            if (instance->m_drainTasks)
+            {
+                try
+                {
+                    ae::TaskScheduler::GetInstance().ExecuteTasks(max_sleepPL);
+                }
+                catch (const std::exception &e)
+                {
+                    UtilitySuite().reportInfo(e.what());
+                }
+            }
+            if (instance->m_trackChanges)
+            {
+                try
+                {
+                    ae::ChangeTracker::GetInstance().poll();
+                }
+                catch (const std::exception &e)
+                {
+                    UtilitySuite().reportInfo(e.what());
+                }
+            }
             instance->onIdle();
         }
         return A_Err_NONE;
@@ -226,8 +251,25 @@ class Plugin
 
     inline void registerIdleHook() { RegisterSuite().registerIdleHook(instance->IdleHook, NULL); }
 
+    /**
+     * Enables or disables draining the TaskScheduler from the idle hook (enabled by default).
+     * When enabled, each idle call runs queued tasks until the scheduler's time budget is used up, and adjusts AE's
+     * sleep hint to match. Disable it if you want to call ae::TaskScheduler::ExecuteTask() yourself in onIdle().
+     * @param enable Whether the idle hook drains the task queue.
+     */
+    inline void setTaskDrain(bool enable) { m_drainTasks = enable; }
+
+    /**
+     * Enables or disables polling ae::ChangeTracker from the idle hook (disabled by default).
+     * When enabled, each idle call checks the watched items and notifies subscribers of the ones that changed.
+     * @param enable Whether the idle hook polls the change tracker.
+     */
+    inline void setChangeTracking(bool enable) { m_trackChanges = enable; }
+
   private:
     SuiteManager &m_suiteManager;
+    bool m_drainTasks = true;
+    bool m_trackChanges = false;
     std::vector<std::unique_ptr<Command>> m_commands; // use std, depending on preprocessor directives, will be either
                                                       // std:: or AE:: (custom allocated and owned by AE)
     inline void clearCommands() { m_commands.clear(); }
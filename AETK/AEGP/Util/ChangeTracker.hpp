@@ -0,0 +1,316 @@
+/*****************************************************************/ /**
+                                                                     * \file   ChangeTracker.hpp
+                                                                     * \brief  Tells caches which watched items changed,
+                                                                     *using render timestamps.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef CHANGE_TRACKER_HPP
+#define CHANGE_TRACKER_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Properties.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class ChangeTracker
+ * @brief Records a render timestamp per watched comp or footage item and reports which ones changed.
+ *
+ * poll() runs on the main thread (Plugin's idle hook calls it when change tracking is enabled). It first compares
+ * AE's project-wide render timestamp with the last one seen, so an idle with no edits costs one host call. When the
+ * project did change, each watched item is asked whether it changed since its own timestamp
+ * (AEGP_HasItemChangedSinceTimestamp). Only subscribers of the changed items are called, so caches do work in
+ * proportion to the edit, not to the project size.
+ *
+ * Every poll that finds changes advances the token. Callers can keep a token and later ask what changed since.
+ * Any move of the project timestamp also invalidates every PropertyCache, watched items or not, so cached child
+ * properties never outlive an effect deleted in the UI.
+ *
+ * Timestamps only move for edits that affect rendering; renames and other edits that do not change pixels are not
+ * reported.
+ *
+ * @example
+ * auto &tracker = ae::ChangeTracker::GetInstance();
+ * tracker.watch(comp.getItem()->get());
+ * auto id = tracker.subscribe(comp.getItem()->get(), [&snapshot](AEGP_ItemH, ae::ChangeTracker::Token) {
+ *     snapshot.refresh();
+ * });
+ */
+class ChangeTracker
+{
+  public:
+    using Token = std::uint64_t;
+    using SubscriptionId = std::uint64_t;
+    using ItemCallback = std::function<void(AEGP_ItemH item, Token token)>;
+    using Callback = std::function<void(const std::vector<AEGP_ItemH> &changed, Token token)>;
+
+    static ChangeTracker &GetInstance()
+    {
+        static ChangeTracker instance;
+        return instance;
+    }
+
+    ChangeTracker(const ChangeTracker &) = delete;
+    ChangeTracker &operator=(const ChangeTracker &) = delete;
+
+    /**
+     * @brief Starts tracking an item (a comp or footage item). Watching an item twice is a no-op.
+     * @return Token The current token; changes are reported relative to it.
+     */
+    Token watch(AEGP_ItemH item)
+    {
+        CheckNotNull(item, "Error Watching Item. Item is Null");
+        Watched watched = ScheduleOrExecute([item]() {
+                              auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+                              Watched result;
+                              A_Time duration{0, 1};
+                              AE_CHECK(suites.ItemSuite9()->AEGP_GetItemDuration(item, &duration)); // rejects bad items
+                              AE_CHECK(suites.RenderSuite5()->AEGP_GetCurrentTimestamp(&result.stamp));
+                              return result;
+                          })
+                              .get();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        watched.changed = m_token;
+        m_items.emplace(item, watched);
+        return m_token;
+    }
+
+    void unwatch(AEGP_ItemH item)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.erase(item);
+    }
+
+    bool isWatched(AEGP_ItemH item) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.count(item) != 0;
+    }
+
+    /**
+     * @brief The current token. Advances each time poll() finds changes.
+     */
+    Token token() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_token;
+    }
+
+    /**
+     * @brief Watched items that changed after token was handed out.
+     */
+    std::vector<AEGP_ItemH> changedSince(Token since) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<AEGP_ItemH> result;
+        for (const auto &entry : m_items)
+        {
+            if (entry.second.changed > since)
+            {
+                result.push_back(entry.first);
+            }
+        }
+        return result;
+    }
+
+    bool hasChangedSince(AEGP_ItemH item, Token since) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_items.find(item);
+        return it != m_items.end() && it->second.changed > since;
+    }
+
+    /**
+     * @brief Calls callback after each poll that finds changes, with every changed item.
+     */
+    SubscriptionId subscribe(Callback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const SubscriptionId id = ++m_nextSubscription;
+        m_listeners.emplace(id, std::move(callback));
+        return id;
+    }
+
+    /**
+     * @brief Calls callback when one item changes. The item must also be watched.
+     */
+    SubscriptionId subscribe(AEGP_ItemH item, ItemCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const SubscriptionId id = ++m_nextSubscription;
+        m_itemListeners[item].emplace(id, std::move(callback));
+        m_listenerItems.emplace(id, item);
+        return id;
+    }
+
+    void unsubscribe(SubscriptionId id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_listeners.erase(id))
+        {
+            return;
+        }
+        auto it = m_listenerItems.find(id);
+        if (it != m_listenerItems.end())
+        {
+            auto listeners = m_itemListeners.find(it->second);
+            if (listeners != m_itemListeners.end())
+            {
+                listeners->second.erase(id);
+                if (listeners->second.empty())
+                {
+                    m_itemListeners.erase(listeners);
+                }
+            }
+            m_listenerItems.erase(it);
+        }
+    }
+
+    /**
+     * @brief Checks the watched items and notifies subscribers of the ones that changed. Main thread only.
+     *
+     * Each item's duration is read again on every check, so a comp that was lengthened is checked over its whole
+     * range. Items AE reports an error for (usually because they were deleted) are unwatched and not reported.
+     * The project timestamp is read even with nothing watched, so PropertyCache entries are dropped after any edit.
+     * @return std::size_t The number of changed items.
+     */
+    std::size_t poll()
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *renderSuite = suites.RenderSuite5();
+        auto *itemSuite = suites.ItemSuite9();
+        AEGP_TimeStamp now;
+        AE_CHECK(renderSuite->AEGP_GetCurrentTimestamp(&now));
+        if (m_polled && std::memcmp(&now, &m_lastStamp, sizeof(now)) == 0)
+        {
+            return 0;
+        }
+        const bool firstPoll = !m_polled;
+        m_lastStamp = now;
+        m_polled = true;
+        if (!firstPoll)
+        {
+            PropertyCache::invalidateAll(); // streams may have been deleted or reordered in the UI
+        }
+
+        std::vector<std::pair<AEGP_ItemH, Watched>> items;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_items.empty())
+            {
+                return 0;
+            }
+            items.assign(m_items.begin(), m_items.end());
+        }
+
+        std::vector<AEGP_ItemH> changed;
+        std::vector<AEGP_ItemH> failed;
+        const A_Time start{0, 1};
+        for (const auto &entry : items)
+        {
+            if (std::memcmp(&entry.second.stamp, &now, sizeof(now)) == 0)
+            {
+                continue;
+            }
+            A_Time duration{0, 1};
+            A_Boolean itemChanged = FALSE;
+            if (itemSuite->AEGP_GetItemDuration(entry.first, &duration) != A_Err_NONE ||
+                renderSuite->AEGP_HasItemChangedSinceTimestamp(entry.first, &start, &duration, &entry.second.stamp,
+                                                               &itemChanged) != A_Err_NONE)
+            {
+                failed.push_back(entry.first);
+                continue;
+            }
+            if (itemChanged)
+            {
+                changed.push_back(entry.first);
+            }
+        }
+
+        Token token = 0;
+        std::vector<Callback> listeners;
+        std::vector<std::pair<AEGP_ItemH, ItemCallback>> itemListeners;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (AEGP_ItemH item : failed)
+            {
+                m_items.erase(item);
+            }
+            for (auto &entry : m_items)
+            {
+                entry.second.stamp = now;
+            }
+            if (changed.empty())
+            {
+                return 0;
+            }
+            LazyTimeBase::InvalidateAll(); // a comp's frame rate may be among the changes
+            token = ++m_token;
+            for (AEGP_ItemH item : changed)
+            {
+                auto it = m_items.find(item);
+                if (it == m_items.end())
+                {
+                    continue; // unwatched while polling
+                }
+                it->second.changed = token;
+                auto listenersOfItem = m_itemListeners.find(item);
+                if (listenersOfItem != m_itemListeners.end())
+                {
+                    for (const auto &listener : listenersOfItem->second)
+                    {
+                        itemListeners.emplace_back(item, listener.second);
+                    }
+                }
+            }
+            for (const auto &listener : m_listeners)
+            {
+                listeners.push_back(listener.second);
+            }
+        }
+
+        // Callbacks run without the lock so they may watch, subscribe or query the tracker.
+        for (const auto &listener : itemListeners)
+        {
+            listener.second(listener.first, token);
+        }
+        for (const auto &listener : listeners)
+        {
+            listener(changed, token);
+        }
+        return changed.size();
+    }
+
+  private:
+    ChangeTracker() = default;
+
+    struct Watched
+    {
+        AEGP_TimeStamp stamp{};
+        Token changed = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<AEGP_ItemH, Watched> m_items;
+    std::unordered_map<SubscriptionId, Callback> m_listeners;
+    std::unordered_map<AEGP_ItemH, std::unordered_map<SubscriptionId, ItemCallback>> m_itemListeners;
+    std::unordered_map<SubscriptionId, AEGP_ItemH> m_listenerItems;
+    SubscriptionId m_nextSubscription = 0;
+    Token m_token = 0;
+    AEGP_TimeStamp m_lastStamp{}; // main thread only
+    bool m_polled = false;        // main thread only
+};
+
+} // namespace ae
+
+#endif // CHANGE_TRACKER_HPP
@@ -0,0 +1,411 @@
+/*****************************************************************/ /**
+                                                                     * \file   CompSnapshot.hpp
+                                                                     * \brief  Flat, structure-of-arrays copy of a
+                                                                     *comp's layers.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef COMP_SNAPSHOT_HPP
+#define COMP_SNAPSHOT_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Items.hpp"
+#include "AETK/AEGP/Util/Transaction.hpp"
+
+#include <array>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class CompSnapshot
+ * @brief Every layer attribute a comp linter or dumper needs, read in one main-thread task.
+ *
+ * Row i of every array describes the layer at comp index i. Once captured, a snapshot needs no host access, so
+ * worker threads can analyse it in parallel (e.g. split the rows across WorkerPool tasks).
+ *
+ * refresh() brings a snapshot up to date in one task, re-reading only rows that may have changed: new or moved
+ * layers, layers whose in or out point moved, and layers whose time span in the comp changed since the snapshot's
+ * render timestamp. The timestamp only tracks changes that affect rendering, so layer names and labels are only
+ * updated by capture() or by a refresh that re-reads the row for another reason. If a read throws, the snapshot
+ * keeps its previous rows and timestamp.
+ *
+ * @example
+ * auto snapshot = ae::CompSnapshot::capture(comp, comp.currentTime());
+ * ae::WorkerPool::GetInstance().submit([snapshot] {
+ *     for (std::size_t i = 0; i < snapshot.size(); ++i)
+ *         if (snapshot.opacity[i] == 0.0 && snapshot.hasFlag(i, LayerFlag::VIDEO_ACTIVE))
+ *             report(snapshot.names[i] + " is invisible");
+ * });
+ */
+class CompSnapshot
+{
+  public:
+    AEGP_CompH comp = nullptr;
+    AEGP_ItemH compItem = nullptr;
+    double time = 0.0;          // comp time (seconds) of the transform values
+    bool preExpression = false; // whether transform values were read before expressions
+
+    std::vector<AEGP_LayerH> layers;
+    std::vector<A_long> ids;
+    std::vector<std::string> names;
+    std::vector<AEGP_LayerFlags> flags;
+    std::vector<double> inPoints;  // comp time, seconds
+    std::vector<double> durations; // comp time, seconds
+    std::vector<double> offsets;   // seconds
+    std::vector<double> stretches; // 1.0 = 100%
+    std::vector<AEGP_LayerH> parentLayers;
+    std::vector<std::ptrdiff_t> parents; // row of the parent layer, or -1
+    std::vector<AEGP_ItemH> sourceItems; // nullptr for layers without a source (cameras, lights, text, shapes)
+    std::vector<ObjectType> objectTypes;
+    std::vector<LayerQual> qualities;
+    std::vector<AEGP_LayerTransferMode> transferModes;
+    // Transform streams a layer does not have hold the identity value: 0 for anchor point, position and rotation,
+    // 100 for scale and opacity.
+    std::array<std::vector<double>, 3> anchorPoint; // anchorPoint[axis][row]
+    std::array<std::vector<double>, 3> position;    // position[axis][row]
+    std::array<std::vector<double>, 3> scale;       // scale[axis][row], percent
+    std::vector<double> rotation;                   // z rotation, degrees
+    std::vector<double> opacity;                    // percent
+
+    std::size_t size() const { return layers.size(); }
+    bool empty() const { return layers.empty(); }
+
+    int index(std::size_t row) const { return static_cast<int>(row); }
+
+    bool hasFlag(std::size_t row, LayerFlag flag) const { return (flags[row] & static_cast<int>(flag)) != 0; }
+
+    /**
+     * @brief The row of a layer handle, or -1.
+     */
+    std::ptrdiff_t rowOf(AEGP_LayerH layer) const
+    {
+        for (std::size_t row = 0; row < layers.size(); ++row)
+        {
+            if (layers[row] == layer)
+            {
+                return static_cast<std::ptrdiff_t>(row);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Reads every layer of a comp in a single main-thread task.
+     * @param time Comp time (seconds) for the transform values.
+     * @param preExpression Whether to read transform values before expressions.
+     */
+    static CompSnapshot capture(CompItem &comp, double time = 0.0, bool preExpression = false)
+    {
+        CompPtr compH = comp.getComp();
+        CheckNotNull(compH.get(), "Error Capturing Comp Snapshot. Comp is Null");
+        AEGP_CompH handle = compH->get();
+        return batch([handle, time, preExpression] {
+                   CompSnapshot snapshot;
+                   snapshot.comp = handle;
+                   snapshot.time = time;
+                   snapshot.preExpression = preExpression;
+                   snapshot.readAll();
+                   return snapshot;
+               })
+            .get();
+    }
+
+    /**
+     * @brief Re-reads the rows that may have changed since the snapshot was taken, in a single main-thread task.
+     * @return The number of rows that were read again.
+     */
+    std::size_t refresh()
+    {
+        return batch([this] { return refreshRows(); }).get();
+    }
+
+  private:
+    // Main thread only.
+    void readAll()
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        AE_CHECK(suites.CompSuite11()->AEGP_GetItemFromComp(comp, &compItem));
+        AE_CHECK(suites.RenderSuite5()->AEGP_GetCurrentTimestamp(&m_stamp));
+        m_base = TimeBase::fromComp(comp);
+        const std::vector<AEGP_LayerH> current = compLayers();
+        clearRows();
+        reserveRows(current.size());
+        for (AEGP_LayerH layer : current)
+        {
+            readRow(layer);
+        }
+        linkParents();
+    }
+
+    // Main thread only.
+    std::size_t refreshRows()
+    {
+        auto *renderSuite = SuiteManager::GetInstance().GetSuiteHandler().RenderSuite5();
+        AEGP_TimeStamp now;
+        AE_CHECK(renderSuite->AEGP_GetCurrentTimestamp(&now));
+        if (std::memcmp(&now, &m_stamp, sizeof(now)) == 0)
+        {
+            return 0;
+        }
+
+        const std::vector<AEGP_LayerH> current = compLayers();
+        std::unordered_map<AEGP_LayerH, std::size_t> oldRows;
+        for (std::size_t row = 0; row < layers.size(); ++row)
+        {
+            oldRows.emplace(layers[row], row);
+        }
+
+        // Built aside and swapped in at the end, so a read that throws leaves this snapshot as it was.
+        CompSnapshot next;
+        next.comp = comp;
+        next.compItem = compItem;
+        next.time = time;
+        next.preExpression = preExpression;
+        next.m_base = TimeBase::fromComp(comp);
+        next.reserveRows(current.size());
+
+        std::size_t reread = 0;
+        for (std::size_t row = 0; row < current.size(); ++row)
+        {
+            auto it = oldRows.find(current[row]);
+            if (it != oldRows.end() && it->second == row && !rowChanged(row))
+            {
+                next.copyRow(*this, row);
+            }
+            else
+            {
+                next.readRow(current[row]);
+                ++reread;
+            }
+        }
+        next.linkParents();
+        next.m_stamp = now;
+        *this = std::move(next);
+        return reread;
+    }
+
+    // Whether the layer's time span moved, or the comp's rendering changed inside it, since the snapshot was taken.
+    // The span is compared first: an extended out point renders differently only after the old span ends.
+    bool rowChanged(std::size_t row) const
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *layerSuite = suites.LayerSuite9();
+        A_Time inPoint{0, 1}, duration{0, 1};
+        AE_CHECK(layerSuite->AEGP_GetLayerInPoint(layers[row], AEGP_LTimeMode_CompTime, &inPoint));
+        AE_CHECK(layerSuite->AEGP_GetLayerDuration(layers[row], AEGP_LTimeMode_CompTime, &duration));
+        if (TimeBase::timeToSeconds(inPoint) != inPoints[row] || TimeBase::timeToSeconds(duration) != durations[row])
+        {
+            return true;
+        }
+
+        if (duration.value <= 0)
+        {
+            duration = m_base.frameDuration();
+        }
+        A_Boolean changed = FALSE;
+        AE_CHECK(suites.RenderSuite5()->AEGP_HasItemChangedSinceTimestamp(compItem, &inPoint, &duration, &m_stamp,
+                                                                          &changed));
+        return changed != FALSE;
+    }
+
+    std::vector<AEGP_LayerH> compLayers() const
+    {
+        auto *layerSuite = SuiteManager::GetInstance().GetSuiteHandler().LayerSuite9();
+        A_long numLayers = 0;
+        AE_CHECK(layerSuite->AEGP_GetCompNumLayers(comp, &numLayers));
+        std::vector<AEGP_LayerH> result(static_cast<std::size_t>(numLayers));
+        for (A_long i = 0; i < numLayers; ++i)
+        {
+            AE_CHECK(layerSuite->AEGP_GetCompLayerByIndex(comp, i, &result[i]));
+        }
+        return result;
+    }
+
+    void readRow(AEGP_LayerH layer)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *layerSuite = suites.LayerSuite9();
+        auto *streamSuite = suites.StreamSuite6();
+        const AEGP_PluginID pluginID = *SuiteManager::GetInstance().GetPluginID();
+
+        layers.push_back(layer);
+
+        A_long id = 0;
+        AE_CHECK(layerSuite->AEGP_GetLayerID(layer, &id));
+        ids.push_back(id);
+
+        AEGP_MemHandle nameH = nullptr, sourceNameH = nullptr;
+        AE_CHECK(layerSuite->AEGP_GetLayerName(pluginID, layer, &nameH, &sourceNameH));
+        std::string name = memHandleToString(nameH);
+        std::string sourceName = memHandleToString(sourceNameH);
+        names.push_back(name.empty() ? std::move(sourceName) : std::move(name));
+
+        AEGP_LayerFlags layerFlags = AEGP_LayerFlag_NONE;
+        AE_CHECK(layerSuite->AEGP_GetLayerFlags(layer, &layerFlags));
+        flags.push_back(layerFlags);
+
+        A_Time inPoint{0, 1}, duration{0, 1}, offset{0, 1};
+        AE_CHECK(layerSuite->AEGP_GetLayerInPoint(layer, AEGP_LTimeMode_CompTime, &inPoint));
+        AE_CHECK(layerSuite->AEGP_GetLayerDuration(layer, AEGP_LTimeMode_CompTime, &duration));
+        AE_CHECK(layerSuite->AEGP_GetLayerOffset(layer, &offset));
+        inPoints.push_back(TimeBase::timeToSeconds(inPoint));
+        durations.push_back(TimeBase::timeToSeconds(duration));
+        offsets.push_back(TimeBase::timeToSeconds(offset));
+
+        A_Ratio stretch{1, 1};
+        AE_CHECK(layerSuite->AEGP_GetLayerStretch(layer, &stretch));
+        stretches.push_back(stretch.den == 0 ? 1.0 : static_cast<double>(stretch.num) / stretch.den);
+
+        AEGP_LayerH parent = nullptr;
+        AE_CHECK(layerSuite->AEGP_GetLayerParent(layer, &parent));
+        parentLayers.push_back(parent);
+
+        AEGP_ObjectType objectType = AEGP_ObjectType_NONE;
+        AE_CHECK(layerSuite->AEGP_GetLayerObjectType(layer, &objectType));
+        objectTypes.push_back(static_cast<ObjectType>(objectType));
+
+        AEGP_ItemH source = nullptr;
+        if (objectType == AEGP_ObjectType_AV)
+        {
+            AE_CHECK(layerSuite->AEGP_GetLayerSourceItem(layer, &source));
+        }
+        sourceItems.push_back(source);
+
+        AEGP_LayerQuality quality = AEGP_LayerQual_NONE;
+        AE_CHECK(layerSuite->AEGP_GetLayerQuality(layer, &quality));
+        qualities.push_back(static_cast<LayerQual>(quality));
+
+        AEGP_LayerTransferMode transferMode{};
+        AE_CHECK(layerSuite->AEGP_GetLayerTransferMode(layer, &transferMode));
+        transferModes.push_back(transferMode);
+
+        const A_Time at = m_base.secondsToTime(time);
+        // Streams a layer does not have (e.g. scale on a camera) read as the identity value `fallback`.
+        auto readStream = [&](AEGP_LayerStream which, double *out, double fallback) {
+            A_Boolean legal = FALSE;
+            AE_CHECK(streamSuite->AEGP_IsStreamLegal(layer, which, &legal));
+            if (!legal)
+            {
+                out[0] = out[1] = out[2] = fallback;
+                return;
+            }
+            AEGP_StreamVal2 value{};
+            AEGP_StreamType type = AEGP_StreamType_NO_DATA;
+            AE_CHECK(streamSuite->AEGP_GetLayerStreamValue(layer, which, AEGP_LTimeMode_CompTime, &at, preExpression,
+                                                           &value, &type));
+            switch (type)
+            {
+            case AEGP_StreamType_ThreeD:
+            case AEGP_StreamType_ThreeD_SPATIAL:
+                out[0] = value.three_d.x;
+                out[1] = value.three_d.y;
+                out[2] = value.three_d.z;
+                break;
+            case AEGP_StreamType_TwoD:
+            case AEGP_StreamType_TwoD_SPATIAL:
+                out[0] = value.two_d.x;
+                out[1] = value.two_d.y;
+                out[2] = 0.0;
+                break;
+            default:
+                out[0] = value.one_d;
+                break;
+            }
+        };
+
+        double components[3] = {};
+        readStream(AEGP_LayerStream_ANCHORPOINT, components, 0.0);
+        pushAxes(anchorPoint, components);
+        readStream(AEGP_LayerStream_POSITION, components, 0.0);
+        pushAxes(position, components);
+        readStream(AEGP_LayerStream_SCALE, components, 100.0);
+        pushAxes(scale, components);
+        readStream(AEGP_LayerStream_ROTATION, components, 0.0);
+        rotation.push_back(components[0]);
+        readStream(AEGP_LayerStream_OPACITY, components, 100.0);
+        opacity.push_back(components[0]);
+
+        parents.push_back(-1); // resolved by linkParents once every row is known
+    }
+
+    void copyRow(const CompSnapshot &from, std::size_t row)
+    {
+        layers.push_back(from.layers[row]);
+        ids.push_back(from.ids[row]);
+        names.push_back(from.names[row]);
+        flags.push_back(from.flags[row]);
+        inPoints.push_back(from.inPoints[row]);
+        durations.push_back(from.durations[row]);
+        offsets.push_back(from.offsets[row]);
+        stretches.push_back(from.stretches[row]);
+        parentLayers.push_back(from.parentLayers[row]);
+        parents.push_back(-1);
+        sourceItems.push_back(from.sourceItems[row]);
+        objectTypes.push_back(from.objectTypes[row]);
+        qualities.push_back(from.qualities[row]);
+        transferModes.push_back(from.transferModes[row]);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            anchorPoint[axis].push_back(from.anchorPoint[axis][row]);
+            position[axis].push_back(from.position[axis][row]);
+            scale[axis].push_back(from.scale[axis][row]);
+        }
+        rotation.push_back(from.rotation[row]);
+        opacity.push_back(from.opacity[row]);
+    }
+
+    void linkParents()
+    {
+        std::unordered_map<AEGP_LayerH, std::ptrdiff_t> rows;
+        for (std::size_t row = 0; row < layers.size(); ++row)
+        {
+            rows.emplace(layers[row], static_cast<std::ptrdiff_t>(row));
+        }
+        for (std::size_t row = 0; row < layers.size(); ++row)
+        {
+            auto it = rows.find(parentLayers[row]);
+            parents[row] = it == rows.end() ? -1 : it->second;
+        }
+    }
+
+    template <typename Func> void forEachColumn(Func &&func)
+    {
+        func(layers), func(ids), func(names), func(flags), func(inPoints), func(durations), func(offsets);
+        func(stretches), func(parentLayers), func(parents), func(sourceItems), func(objectTypes), func(qualities);
+        func(transferModes), func(rotation), func(opacity);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            func(anchorPoint[axis]), func(position[axis]), func(scale[axis]);
+        }
+    }
+
+    void clearRows()
+    {
+        forEachColumn([](auto &column) { column.clear(); });
+    }
+
+    void reserveRows(std::size_t count)
+    {
+        forEachColumn([count](auto &column) { column.reserve(count); });
+    }
+
+    static void pushAxes(std::array<std::vector<double>, 3> &columns, const double *components)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            columns[axis].push_back(components[axis]);
+        }
+    }
+
+    AEGP_TimeStamp m_stamp{}; // render timestamp the rows are valid for
+    TimeBase m_base;          // the comp's frame rate, for time conversions
+};
+
+} // namespace ae
+
+#endif // COMP_SNAPSHOT_HPP
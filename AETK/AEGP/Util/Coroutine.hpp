@@ -0,0 +1,299 @@
+/*****************************************************************/ /**
+                                                                     * \file   Coroutine.hpp
+                                                                     * \brief  C++20 coroutine interface over the
+                                                                     *TaskScheduler and WorkerPool.
+                                                                     *
+                                                                     * Only available when the compiler supports
+                                                                     *coroutines (/std:c++20 or later); with C++17
+                                                                     *this header is empty.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#define AETK_HAS_COROUTINES 1
+
+#include "AETK/AEGP/Util/TaskScheduler.hpp"
+#include "AETK/AEGP/Util/WorkerPool.hpp"
+
+#include <coroutine>
+
+/**
+ * Usage Example:
+ * ```
+ * ae::task<void> renameAll(CompItem comp)
+ * {
+ *     co_await ae::on_main_thread();
+ *     auto layers = comp.layers();             // AE access, main thread
+ *     std::vector<std::string> names;
+ *     for (auto &layer : *layers) names.push_back(layer->getName());
+ *
+ *     co_await ae::on_worker_pool();
+ *     for (auto &name : names) name = slugify(name); // CPU work, no thread is parked meanwhile
+ *
+ *     co_await ae::on_main_thread();
+ *     for (std::size_t i = 0; i < names.size(); ++i) (*layers)[i]->setName(names[i]);
+ * }
+ *
+ * ae::spawn(renameAll(CompItem::activeItem()));
+ * ```
+ * Main-thread resumptions are queued on the TaskScheduler and run from the plugin's idle hook, so the idle hook
+ * must be registered (Plugin::registerIdleHook) for coroutines to make progress.
+ */
+namespace ae
+{
+
+/**
+ * @brief Awaitable that continues the coroutine on AE's main thread.
+ */
+class MainThreadAwaiter
+{
+  public:
+    explicit MainThreadAwaiter(bool callIdle, TaskPriority priority) : m_callIdle(callIdle), m_priority(priority) {}
+
+    bool await_ready() const noexcept { return IsMainThread(); }
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        TaskScheduler::GetInstance().ScheduleTask([handle] { handle.resume(); }, m_callIdle, m_priority);
+    }
+    void await_resume() const noexcept {}
+
+  private:
+    bool m_callIdle;
+    TaskPriority m_priority;
+};
+
+/**
+ * @brief Awaitable that continues the coroutine on a WorkerPool thread.
+ */
+class WorkerPoolAwaiter
+{
+  public:
+    explicit WorkerPoolAwaiter(WorkerPool &pool) : m_pool(pool) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        m_pool.post([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+  private:
+    WorkerPool &m_pool;
+};
+
+/**
+ * @brief Hops to AE's main thread (no-op if already there).
+ * @param callIdle Flag indicating whether to call idle routines for quicker response.
+ * @param priority The TaskScheduler lane to resume on.
+ */
+inline MainThreadAwaiter on_main_thread(bool callIdle = true,
+                                        TaskPriority priority = TaskScheduler::CurrentPriority())
+{
+    return MainThreadAwaiter(callIdle, priority);
+}
+
+/**
+ * @brief Hops to a worker thread of the given pool.
+ */
+inline WorkerPoolAwaiter on_worker_pool(WorkerPool &pool = WorkerPool::GetInstance())
+{
+    return WorkerPoolAwaiter(pool);
+}
+
+template <typename T = void> class task;
+
+namespace detail
+{
+class TaskPromiseBase
+{
+  public:
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            auto continuation = handle.promise().m_continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { m_error = std::current_exception(); }
+
+    void setContinuation(std::coroutine_handle<> continuation) noexcept { m_continuation = continuation; }
+
+  protected:
+    void rethrowIfFailed() const
+    {
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+  private:
+    std::coroutine_handle<> m_continuation;
+    std::exception_ptr m_error;
+};
+
+template <typename T> class TaskPromise : public TaskPromiseBase
+{
+  public:
+    task<T> get_return_object() noexcept;
+
+    template <typename U> void return_value(U &&value) { m_value.emplace(std::forward<U>(value)); }
+
+    T result()
+    {
+        rethrowIfFailed();
+        return std::move(*m_value);
+    }
+
+  private:
+    std::optional<T> m_value;
+};
+
+template <> class TaskPromise<void> : public TaskPromiseBase
+{
+  public:
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() { rethrowIfFailed(); }
+};
+} // namespace detail
+
+/**
+ * @class task
+ * @brief Lazily started coroutine returning T.
+ *
+ * The body starts when the task is awaited (or handed to ae::spawn) and resumes its awaiter when it finishes,
+ * on whichever thread it finished on.
+ */
+template <typename T> class task
+{
+  public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit task(handle_type handle) noexcept : m_handle(handle) {}
+    task(task &&other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    task &operator=(task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    auto operator co_await() noexcept
+    {
+        struct Awaiter
+        {
+            handle_type handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().setContinuation(awaiting);
+                return handle;
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+  private:
+    handle_type m_handle;
+};
+
+namespace detail
+{
+template <typename T> task<T> TaskPromise<T>::get_return_object() noexcept
+{
+    return task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline task<void> TaskPromise<void>::get_return_object() noexcept
+{
+    return task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief Eagerly started, self-destroying coroutine used to run a task without an awaiter.
+ */
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+template <typename T> Detached RunDetached(task<T> work, std::promise<T> promise)
+{
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await work;
+            promise.set_value();
+        }
+        else
+        {
+            promise.set_value(co_await work);
+        }
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Starts a task without awaiting it.
+ *
+ * The task runs on the calling thread until its first hop. Only call get() on the returned future from a
+ * thread other than the main thread; blocking the main thread would stop the idle hook that resumes it.
+ * @return std::future<T> Receives the task's result or exception.
+ */
+template <typename T> std::future<T> spawn(task<T> work)
+{
+    std::promise<T> promise;
+    auto future = promise.get_future();
+    detail::RunDetached(std::move(work), std::move(promise));
+    return future;
+}
+
+} // namespace ae
+
+#endif // coroutine support
+
+#endif // COROUTINE_HPP
@@ -10,8 +10,75 @@
 
 #include <AETK/AEGP/Core/Core.hpp>
 
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
 class BaseProperty;
 class Layer;
+
+/**
+ * @brief A lookup table of the effects installed in After Effects.
+ *
+ * Finding an effect by match name otherwise means walking every installed effect with two suite calls per step.
+ * The registry walks them once per session, in a single main-thread task, and keeps each effect's installed key,
+ * display name and category. The installed effects do not change while AE is running; call refresh() if a plugin
+ * is known to have been added.
+ */
+class EffectRegistry
+{
+  public:
+    struct Info
+    {
+        AEGP_InstalledEffectKey key = AEGP_InstalledEffectKey_NONE;
+        std::string matchName;
+        std::string name;
+        std::string category;
+    };
+
+    static EffectRegistry &GetInstance()
+    {
+        static EffectRegistry instance;
+        return instance;
+    }
+
+    /**
+     * @brief The installed key for a match name, or std::nullopt if no such effect is installed.
+     */
+    std::optional<AEGP_InstalledEffectKey> keyFor(const std::string &matchName);
+
+    std::optional<Info> find(const std::string &matchName);
+    std::optional<Info> find(AEGP_InstalledEffectKey key);
+
+    /**
+     * @brief Every installed effect, in AE's order.
+     */
+    tk::vector<Info> effects();
+
+    std::size_t size();
+
+    /**
+     * @brief Discards the table; the next lookup walks the installed effects again.
+     */
+    void refresh();
+
+  private:
+    struct Table
+    {
+        tk::vector<Info> effects;
+        std::unordered_map<std::string, std::size_t> byMatchName;
+        std::unordered_map<AEGP_InstalledEffectKey, std::size_t> byKey;
+    };
+
+    EffectRegistry() = default;
+
+    std::shared_ptr<const Table> table();
+    static std::shared_ptr<const Table> buildTable();
+
+    std::mutex m_mutex;
+    std::shared_ptr<const Table> m_table;
+};
+
 /**
  * @brief The Effect class represents an After Effects effect.
  *
@@ -24,9 +91,18 @@ class Effect
     {
     }
     Effect(EffectRefPtr effect) : m_effect(effect){};
+    Effect(EffectRefPtr effect, AEGP_InstalledEffectKey key) : m_effect(effect), m_key(key){};
 
     ~Effect() = default;
     static tk::shared_ptr<Effect> apply(tk::shared_ptr<Layer> layer, const std::string &name);
+
+    /**
+     * @brief Applies the same effect to every layer in one main-thread task and one undo group.
+     * @return The applied effects, in layer order; empty if no effect with that match name is installed.
+     */
+    static tk::vector<tk::shared_ptr<Effect>> applyToLayers(const tk::vector<tk::shared_ptr<Layer>> &layers,
+                                                            const std::string &matchName,
+                                                            const std::string &undoName = "Apply Effect");
     std::string name();      // get the name of the effect
     std::string matchName(); // get the match name of the effect
     std::string category();  // get the category of the effect
@@ -39,8 +115,10 @@ class Effect
     tk::shared_ptr<Effect> duplicate(); // duplicate the effect
 
   private:
+    AEGP_InstalledEffectKey key(); // looked up from the effect ref on first use
+
     EffectRefPtr m_effect;
-    int m_key;
+    AEGP_InstalledEffectKey m_key = AEGP_InstalledEffectKey_NONE;
 };
 
 #endif // EFFECTS_HPP
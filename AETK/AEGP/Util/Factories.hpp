@@ -18,9 +18,11 @@
 class ItemFactory
 {
   public:
-    inline static tk::shared_ptr<Item> createItem(ItemPtr item)
+    inline static tk::shared_ptr<Item> createItem(ItemPtr item) { return createItem(item, ItemSuite().GetItemType(item)); }
+
+    // For callers that already know the type, e.g. from an ae::ProjectIndex.
+    inline static tk::shared_ptr<Item> createItem(ItemPtr item, ItemType type)
     {
-        ItemType type = ItemSuite().GetItemType(item);
         switch (type)
         {
         case ItemType::FOLDER:
@@ -0,0 +1,595 @@
+/*****************************************************************/ /**
+                                                                     * \file   FrameCache.hpp
+                                                                     * \brief  Memory-mapped container of raw ARGB
+                                                                     *frames for fast render dumps and reloads.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef FRAME_CACHE_HPP
+#define FRAME_CACHE_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Image.hpp"
+#include "AETK/AEGP/Util/ImageView.hpp"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#ifndef AE_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ae
+{
+
+/*
+ * File layout (little-endian):
+ *
+ *   FrameCacheHeader                       at 0
+ *   FrameCacheEntry[frameCount]            at sizeof(FrameCacheHeader)
+ *   frame slots, one per entry             from dataOffset, each slotSize bytes, page aligned
+ *
+ * A slot holds height rows of width ARGB pixels without padding, exactly as PF_Pixel8/16/PixelFloat lay them out,
+ * or, when the entry is flagged LZ4, that block compressed. The header's magic is written last, so a dump that was
+ * interrupted is rejected on open.
+ */
+
+struct FrameCacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t bitDepth; // 8, 16 or 32
+    std::int32_t width;
+    std::int32_t height;
+    std::uint64_t frameBytes; // uncompressed size of one frame
+    std::uint64_t slotSize;   // frameBytes rounded up to the page size
+    std::uint64_t frameCount;
+    std::uint64_t dataOffset;
+};
+
+struct FrameCacheEntry
+{
+    std::uint64_t storedBytes; // bytes used in the slot; 0 when the frame was never written
+    std::int32_t frame;        // frame number the caller stored with it
+    std::uint32_t flags;
+};
+
+/**
+ * @brief A file mapped into memory, read-only or read-write. Used by the frame cache.
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Creates (or truncates) path with the given size and maps it read-write.
+    void create(const std::string &path, std::uint64_t size)
+    {
+        close();
+#ifdef AE_OS_WIN
+        m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw AEException("Error Creating Frame Cache. Could not create " + path);
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr); // also sizes the file
+        m_data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+#else
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0)
+        {
+            throw AEException("Error Creating Frame Cache. Could not create " + path);
+        }
+        if (::ftruncate(m_fd, static_cast<off_t>(size)) == 0)
+        {
+            void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            m_data = data == MAP_FAILED ? nullptr : data;
+        }
+#endif
+        m_size = size;
+        if (!m_data)
+        {
+            close();
+            throw AEException("Error Creating Frame Cache. Could not map " + path);
+        }
+    }
+
+    // Maps an existing file read-only.
+    void open(const std::string &path)
+    {
+        close();
+#ifdef AE_OS_WIN
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw AEException("Error Opening Frame Cache. Could not open " + path);
+        }
+        LARGE_INTEGER size{};
+        GetFileSizeEx(m_file, &size);
+        m_size = static_cast<std::uint64_t>(size.QuadPart);
+        m_mapping = m_size ? CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        m_data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+        {
+            throw AEException("Error Opening Frame Cache. Could not open " + path);
+        }
+        struct stat info{};
+        ::fstat(m_fd, &info);
+        m_size = static_cast<std::uint64_t>(info.st_size);
+        if (m_size)
+        {
+            void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+            m_data = data == MAP_FAILED ? nullptr : data;
+        }
+#endif
+        if (!m_data)
+        {
+            close();
+            throw AEException("Error Opening Frame Cache. Could not map " + path);
+        }
+    }
+
+    // Writes dirty pages back to the file.
+    void flush()
+    {
+        if (!m_data)
+        {
+            return;
+        }
+#ifdef AE_OS_WIN
+        FlushViewOfFile(m_data, 0);
+#else
+        ::msync(m_data, m_size, MS_SYNC);
+#endif
+    }
+
+    void close()
+    {
+#ifdef AE_OS_WIN
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+        }
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data)
+        {
+            ::munmap(m_data, m_size);
+        }
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+        m_fd = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    std::uint8_t *data() const { return static_cast<std::uint8_t *>(m_data); }
+    std::uint64_t size() const { return m_size; }
+
+  private:
+    void *m_data = nullptr;
+    std::uint64_t m_size = 0;
+#ifdef AE_OS_WIN
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+namespace detail
+{
+constexpr char FrameCacheMagic[8] = {'A', 'E', 'T', 'K', 'F', 'C', 'H', '1'};
+constexpr std::uint32_t FrameCacheVersion = 1;
+constexpr std::uint64_t FrameCachePage = 4096;
+constexpr std::uint32_t FrameCacheLZ4 = 1;
+
+inline std::uint64_t AlignToPage(std::uint64_t size)
+{
+    return (size + FrameCachePage - 1) / FrameCachePage * FrameCachePage;
+}
+} // namespace detail
+
+/**
+ * @class FrameCacheWriter
+ * @brief Writes frames of one size and depth into a mapped frame cache file.
+ *
+ * Frames are copied row by row from the source (dropping any row padding) straight into the mapping, so a dump
+ * costs one memcpy per frame and the OS writes the pages back in the background. write() may be called from several
+ * threads at once for different indices. With compression (requires USE_LZ4), each frame is LZ4 compressed into its
+ * slot when that makes it smaller; slot tails are never touched, so they cost no write-back.
+ *
+ * @example
+ * ae::FrameCacheWriter cache(path, width, height, 16, frameCount);
+ * auto pipeline = ae::RenderPipeline::create(options, [&](const ae::RenderedFrame &frame) {
+ *     frame.visit([&](auto view) { cache.write(frame.frame - first, frame.frame, view); });
+ * });
+ */
+class FrameCacheWriter
+{
+  public:
+    FrameCacheWriter(const std::string &path, int width, int height, int bitDepth, std::size_t frameCount,
+                     bool compress = false)
+        : m_compress(compress)
+    {
+        if (width <= 0 || height <= 0 || frameCount == 0)
+        {
+            throw AEException("Error Creating Frame Cache. Size and frame count must be positive");
+        }
+        if (bitDepth != 8 && bitDepth != 16 && bitDepth != 32)
+        {
+            throw AEException("Error Creating Frame Cache. Bit depth must be 8, 16 or 32");
+        }
+#ifndef USE_LZ4
+        if (compress)
+        {
+            throw AEException("Error Creating Frame Cache. Compression requires building with USE_LZ4");
+        }
+#endif
+        FrameCacheHeader &header = m_header;
+        std::memset(&header, 0, sizeof(header));
+        header.version = detail::FrameCacheVersion;
+        header.bitDepth = static_cast<std::uint32_t>(bitDepth);
+        header.width = width;
+        header.height = height;
+        header.frameBytes = static_cast<std::uint64_t>(width) * height * 4 * (bitDepth / 8);
+        header.slotSize = detail::AlignToPage(header.frameBytes);
+        header.frameCount = frameCount;
+        header.dataOffset = detail::AlignToPage(sizeof(FrameCacheHeader) + frameCount * sizeof(FrameCacheEntry));
+        m_file.create(path, header.dataOffset + header.slotSize * frameCount);
+    }
+
+    ~FrameCacheWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    FrameCacheWriter(const FrameCacheWriter &) = delete;
+    FrameCacheWriter &operator=(const FrameCacheWriter &) = delete;
+
+    /**
+     * @brief Stores an ARGB image (same size and depth as the cache) in slot index, tagged with frame.
+     */
+    void write(std::size_t index, A_long frame, const UniformImage &img)
+    {
+        if (!m_file.data())
+        {
+            throw AEException("Error Writing Frame Cache. Cache is closed");
+        }
+        if (index >= m_header.frameCount)
+        {
+            throw AEException("Error Writing Frame Cache. Index is out of range");
+        }
+        CheckNotNull(img.data, "Error Writing Frame Cache. Image data is Null");
+        if (img.width != m_header.width || img.height != m_header.height ||
+            img.bitDepth != static_cast<int>(m_header.bitDepth))
+        {
+            throw AEException("Error Writing Frame Cache. Image size or depth does not match the cache");
+        }
+
+        const std::size_t rowBytes = static_cast<std::size_t>(m_header.frameBytes / m_header.height);
+        const std::size_t pitch = img.rowPitch ? img.rowPitch : rowBytes;
+        std::uint8_t *slot = m_file.data() + m_header.dataOffset + index * m_header.slotSize;
+        FrameCacheEntry entry{};
+        entry.frame = frame;
+        entry.storedBytes = m_header.frameBytes;
+
+        if (!m_compress)
+        {
+            copyRows(static_cast<const std::uint8_t *>(img.data), pitch, slot, rowBytes, m_header.height);
+        }
+#ifdef USE_LZ4
+        else
+        {
+            // LZ4 needs one contiguous block; padded sources are packed first.
+            const std::uint8_t *source = static_cast<const std::uint8_t *>(img.data);
+            thread_local std::vector<std::uint8_t> packed;
+            if (pitch != rowBytes)
+            {
+                packed.resize(static_cast<std::size_t>(m_header.frameBytes));
+                copyRows(source, pitch, packed.data(), rowBytes, m_header.height);
+                source = packed.data();
+            }
+            const int frameBytes = static_cast<int>(m_header.frameBytes);
+            const int size = LZ4_compress_default(reinterpret_cast<const char *>(source),
+                                                  reinterpret_cast<char *>(slot), frameBytes, frameBytes - 1);
+            if (size > 0)
+            {
+                entry.storedBytes = static_cast<std::uint64_t>(size);
+                entry.flags |= detail::FrameCacheLZ4;
+            }
+            else
+            {
+                std::memcpy(slot, source, static_cast<std::size_t>(m_header.frameBytes)); // did not shrink
+            }
+        }
+#endif
+        std::memcpy(entries() + index, &entry, sizeof(entry));
+    }
+
+    template <typename Pixel> void write(std::size_t index, A_long frame, const ImageView<Pixel> &view)
+    {
+        write(index, frame, Image::uniform(view));
+    }
+
+    /**
+     * @brief Writes the header and flushes. The file is only valid once this ran (the destructor calls it too).
+     */
+    void close()
+    {
+        if (!m_file.data())
+        {
+            return;
+        }
+        std::memcpy(m_header.magic, detail::FrameCacheMagic, sizeof(m_header.magic));
+        std::memcpy(m_file.data(), &m_header, sizeof(m_header));
+        m_file.flush();
+        m_file.close();
+    }
+
+    std::size_t size() const { return static_cast<std::size_t>(m_header.frameCount); }
+
+  private:
+    static void copyRows(const std::uint8_t *src, std::size_t srcPitch, std::uint8_t *dst, std::size_t rowBytes,
+                         std::int32_t height)
+    {
+        if (srcPitch == rowBytes)
+        {
+            std::memcpy(dst, src, rowBytes * height);
+            return;
+        }
+        for (std::int32_t y = 0; y < height; ++y)
+        {
+            std::memcpy(dst + y * rowBytes, src + y * srcPitch, rowBytes);
+        }
+    }
+
+    FrameCacheEntry *entries() const
+    {
+        return reinterpret_cast<FrameCacheEntry *>(m_file.data() + sizeof(FrameCacheHeader));
+    }
+
+    MappedFile m_file;
+    FrameCacheHeader m_header;
+    bool m_compress;
+};
+
+/**
+ * @class FrameCacheReader
+ * @brief Maps a frame cache read-only and hands out views of its frames.
+ *
+ * Uncompressed frames are viewed in place: view() returns an ImageView into the mapping and nothing is copied; the
+ * OS pages the frame in on first access. Compressed frames are decompressed into a per-thread buffer that stays valid
+ * until the next call on that thread. Views are valid while the reader is alive.
+ *
+ * @example
+ * ae::FrameCacheReader cache(path);
+ * WorldPtr reference = cache.toWorld(0);
+ * cache.visit(1, [](auto view) { compare(view); });
+ */
+class FrameCacheReader
+{
+  public:
+    explicit FrameCacheReader(const std::string &path)
+    {
+        m_file.open(path);
+        if (m_file.size() < sizeof(FrameCacheHeader))
+        {
+            throw AEException("Error Opening Frame Cache. File is too small");
+        }
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, detail::FrameCacheMagic, sizeof(m_header.magic)) != 0 ||
+            m_header.version != detail::FrameCacheVersion)
+        {
+            throw AEException("Error Opening Frame Cache. Not a frame cache, or it was not closed");
+        }
+        if (m_header.bitDepth != 8 && m_header.bitDepth != 16 && m_header.bitDepth != 32)
+        {
+            throw AEException("Error Opening Frame Cache. Unsupported bit depth");
+        }
+        // Every size below is derived from the header, so check it is the one the writer would have produced.
+        if (m_header.width <= 0 || m_header.height <= 0)
+        {
+            throw AEException("Error Opening Frame Cache. Width and height must be positive");
+        }
+        const std::uint64_t frameBytes = static_cast<std::uint64_t>(m_header.width) *
+                                         static_cast<std::uint64_t>(m_header.height) * 4 * (m_header.bitDepth / 8);
+        if (m_header.frameBytes != frameBytes || m_header.slotSize < frameBytes)
+        {
+            throw AEException("Error Opening Frame Cache. Frame size does not match width, height and bit depth");
+        }
+        // Compared by division: a corrupt count could overflow the products.
+        if (m_header.dataOffset < sizeof(FrameCacheHeader) || m_header.dataOffset > m_file.size() ||
+            m_header.frameCount > (m_header.dataOffset - sizeof(FrameCacheHeader)) / sizeof(FrameCacheEntry) ||
+            m_header.frameCount > (m_file.size() - m_header.dataOffset) / m_header.slotSize)
+        {
+            throw AEException("Error Opening Frame Cache. File is truncated");
+        }
+        for (std::size_t index = 0; index < size(); ++index)
+        {
+            const FrameCacheEntry &stored = entry(index);
+            if (!stored.storedBytes)
+            {
+                continue;
+            }
+            if (stored.flags & detail::FrameCacheLZ4)
+            {
+                // LZ4 sizes are ints.
+                if (stored.storedBytes > m_header.slotSize ||
+                    frameBytes > static_cast<std::uint64_t>((std::numeric_limits<int>::max)()))
+                {
+                    throw AEException("Error Opening Frame Cache. Compressed frame does not fit its slot");
+                }
+            }
+            else if (stored.storedBytes != frameBytes)
+            {
+                throw AEException("Error Opening Frame Cache. Frame entry does not match the frame size");
+            }
+        }
+    }
+
+    FrameCacheReader(const FrameCacheReader &) = delete;
+    FrameCacheReader &operator=(const FrameCacheReader &) = delete;
+
+    std::size_t size() const { return static_cast<std::size_t>(m_header.frameCount); }
+    int width() const { return m_header.width; }
+    int height() const { return m_header.height; }
+    int bitDepth() const { return static_cast<int>(m_header.bitDepth); }
+
+    bool has(std::size_t index) const { return index < size() && entry(index).storedBytes != 0; }
+    A_long frameNumber(std::size_t index) const { return entry(checked(index)).frame; }
+    bool compressed(std::size_t index) const { return (entry(checked(index)).flags & detail::FrameCacheLZ4) != 0; }
+
+    /**
+     * @brief A typed view of frame index. Pixel must match bitDepth(); see visit() for dispatch by depth.
+     */
+    template <typename Pixel> ImageView<const Pixel> view(std::size_t index) const
+    {
+        if (PixelTraits<Pixel>::BitDepth != bitDepth())
+        {
+            throw AEException("Error Reading Frame Cache. Pixel type does not match the cache's bit depth");
+        }
+        return ImageView<const Pixel>(reinterpret_cast<const Pixel *>(pixels(index)), width(), height(),
+                                      static_cast<std::ptrdiff_t>(m_header.frameBytes / m_header.height));
+    }
+
+    /**
+     * @brief Calls func with a read-only view of frame index, typed by the cache's depth. func is instantiated for
+     * ImageView<const PF_Pixel8>, <const PF_Pixel16> and <const PF_PixelFloat>.
+     */
+    template <typename Func> decltype(auto) visit(std::size_t index, Func &&func) const
+    {
+        switch (bitDepth())
+        {
+        case 8:
+            return func(view<PF_Pixel8>(index));
+        case 16:
+            return func(view<PF_Pixel16>(index));
+        default:
+            return func(view<PF_PixelFloat>(index));
+        }
+    }
+
+    /**
+     * @brief A copy of frame index as a UniformImage, for Image::saveImage and friends.
+     *
+     * UniformImage points at mutable pixels and the mapping is read-only, so the frame is copied into a per-thread
+     * buffer that stays valid until the next image() call on that thread. Use view() or visit() to read in place.
+     */
+    UniformImage image(std::size_t index) const
+    {
+        const std::uint8_t *source = pixels(index);
+        thread_local std::vector<std::uint8_t> copy;
+        copy.assign(source, source + static_cast<std::size_t>(m_header.frameBytes));
+        return UniformImage(copy.data(), width(), height(), bitDepth(),
+                            static_cast<size_t>(m_header.frameBytes / m_header.height));
+    }
+
+    /**
+     * @brief Copies frame index into a new AEGP world of the cache's depth.
+     */
+    WorldPtr toWorld(std::size_t index) const
+    {
+        const std::uint8_t *source = pixels(index);
+        const WorldType type = bitDepth() == 8 ? WorldType::W8 : bitDepth() == 16 ? WorldType::W16 : WorldType::W32;
+        WorldPtr world = WorldSuite().newWorld(type, width(), height());
+        const std::size_t rowBytes = static_cast<std::size_t>(m_header.frameBytes / m_header.height);
+        visit_world(world, [source, rowBytes](auto view) {
+            for (A_long y = 0; y < view.height(); ++y)
+            {
+                std::memcpy(view.rowData(y), source + y * rowBytes, rowBytes);
+            }
+        });
+        return world;
+    }
+
+  private:
+    const FrameCacheEntry &entry(std::size_t index) const
+    {
+        return reinterpret_cast<const FrameCacheEntry *>(m_file.data() + sizeof(FrameCacheHeader))[index];
+    }
+
+    std::size_t checked(std::size_t index) const
+    {
+        if (index >= size())
+        {
+            throw AEException("Error Reading Frame Cache. Index is out of range");
+        }
+        return index;
+    }
+
+    // The frame's pixels: in the mapping, or decompressed into this thread's buffer.
+    const std::uint8_t *pixels(std::size_t index) const
+    {
+        const FrameCacheEntry &stored = entry(checked(index));
+        if (!stored.storedBytes)
+        {
+            throw AEException("Error Reading Frame Cache. Frame was never written");
+        }
+        const std::uint8_t *slot = m_file.data() + m_header.dataOffset + index * m_header.slotSize;
+        if (!(stored.flags & detail::FrameCacheLZ4))
+        {
+            return slot;
+        }
+#ifdef USE_LZ4
+        thread_local std::vector<std::uint8_t> decompressed;
+        decompressed.resize(static_cast<std::size_t>(m_header.frameBytes));
+        const int frameBytes = static_cast<int>(m_header.frameBytes);
+        const int size = LZ4_decompress_safe(reinterpret_cast<const char *>(slot),
+                                             reinterpret_cast<char *>(decompressed.data()),
+                                             static_cast<int>(stored.storedBytes), frameBytes);
+        if (size != frameBytes)
+        {
+            throw AEException("Error Reading Frame Cache. Frame is corrupt");
+        }
+        return decompressed.data();
+#else
+        throw AEException("Error Reading Frame Cache. Frame is LZ4 compressed; build with USE_LZ4 to read it");
+#endif
+    }
+
+    MappedFile m_file;
+    FrameCacheHeader m_header;
+};
+
+} // namespace ae
+
+#endif // FRAME_CACHE_HPP
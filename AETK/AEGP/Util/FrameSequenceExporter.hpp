@@ -0,0 +1,572 @@
+/*****************************************************************/ /**
+                                                                     * \file   FrameSequenceExporter.hpp
+                                                                     * \brief  Renders a frame range and writes it as
+                                                                     *an image sequence, one stage per thread group.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef FRAME_SEQUENCE_EXPORTER_HPP
+#define FRAME_SEQUENCE_EXPORTER_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Image.hpp"
+#include "AETK/AEGP/Util/RenderPipeline.hpp"
+#include "AETK/AEGP/Util/WorkerPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ae
+{
+
+enum class ExportFormat
+{
+    PNG, // 8 or 16 bit RGBA
+    TGA, // 8 bit RGBA
+    Raw  // headerless RGBA, 8 or 16 bit little-endian (0..65535); all frames appended to one file in frame order
+};
+
+/**
+ * @brief Settings of a FrameSequenceExporter.
+ */
+struct FrameSequenceExporterOptions
+{
+    std::string directory;       // must exist
+    std::string prefix = "frame";
+    int digits = 4;              // frame number padding in file names
+    ExportFormat format = ExportFormat::PNG;
+    int bitDepth = 8;            // 8 or 16; TGA is always 8
+    int pngCompression = 8;      // zlib level 0..9
+    unsigned encoders = 0;       // encoder threads; 0 uses hardware concurrency - 1
+    std::size_t queueDepth = 8;  // converted frames waiting for an encoder
+    std::size_t reorderDepth = 16; // frames ahead of the next one to write that may be converted
+    RenderPipelineOptions render; // render stage limits; render.pool, if set, must be dedicated to the export and
+                                  // have at least render.maxPending + render.maxInFlight threads
+};
+
+/**
+ * @brief Throughput of one stage. The stage with the highest utilization is the bottleneck.
+ */
+struct StageStats
+{
+    std::size_t frames = 0;
+    std::size_t workers = 0;
+    double busyMs = 0.0;   // summed over workers
+    double activeMs = 0.0; // first start to last finish
+
+    double framesPerSecond() const { return activeMs > 0.0 ? frames * 1000.0 / activeMs : 0.0; }
+    double utilization() const { return activeMs > 0.0 && workers ? busyMs / (activeMs * workers) : 0.0; }
+};
+
+struct ExportStats
+{
+    RenderStats render;
+    StageStats renderStage, convert, encode, write;
+    std::size_t written = 0;
+    std::size_t failed = 0; // failed or canceled in any stage
+    double elapsedMs = 0.0;
+
+    double framesPerSecond() const { return elapsedMs > 0.0 ? written * 1000.0 / elapsedMs : 0.0; }
+};
+
+/**
+ * @class FrameSequenceExporter
+ * @brief Renders a frame range of a layer and writes it as an image sequence.
+ *
+ * The stages overlap, and each is bounded so a slow stage slows the ones before it instead of filling memory:
+ *
+ * - render: a RenderPipeline keeps maxInFlight asynchronous requests queued in AE and copies each frame out
+ * - convert: on a WorkerPool, swizzles ARGB to RGBA at the output depth; waits while queueDepth frames are already
+ *   waiting for an encoder, or while the frame is reorderDepth or more frames ahead of the next one to write
+ * - encode: PNG/TGA compression on the exporter's own encoder threads
+ * - write: one thread writing files strictly in frame order (and calling onWritten in that order), so the output,
+ *   including a Raw stream, does not depend on which encoder finished first
+ *
+ * Encoded frames that finish ahead of an earlier frame wait in memory for it. For Raw they are full size, so the
+ * reorderDepth window bounds how many can wait. Because convert() waits on the writer, every frame the render stage
+ * hands out must get a thread. The render stage stops issuing at maxPending frames, but requests already in flight
+ * still complete, so up to maxPending + maxInFlight - 1 handlers can run at once: the convert pool has
+ * maxPending + maxInFlight threads. It is the exporter's own unless render.pool names a dedicated pool that large;
+ * the shared WorkerPool is refused, since convert() may block its threads.
+ *
+ * @example
+ * ae::FrameSequenceExporterOptions options;
+ * options.directory = "C:\\renders";
+ * ae::FrameSequenceExporter exporter(renderOptions, options);
+ * ae::ExportStats stats = exporter.run(0, 239, ae::TimeBase::fromComp(comp->get())); // from a background thread
+ */
+class FrameSequenceExporter
+{
+  public:
+    using Options = FrameSequenceExporterOptions;
+    using FrameWritten = std::function<void(A_long frame, const std::string &path)>;
+
+    FrameSequenceExporter(LayerRenderOptionsPtr renderOptions, Options options)
+        : m_renderOptions(std::move(renderOptions)), m_options(std::move(options))
+    {
+        CheckNotNull(m_renderOptions.get(), "Error Creating Frame Sequence Exporter. Render options are Null");
+        if (m_options.bitDepth != 8 && m_options.bitDepth != 16)
+        {
+            throw AEException("Error Creating Frame Sequence Exporter. Bit depth must be 8 or 16");
+        }
+        if (m_options.format == ExportFormat::TGA)
+        {
+            m_options.bitDepth = 8;
+        }
+        if (!m_options.encoders)
+        {
+            const unsigned threads = std::thread::hardware_concurrency(); // 0 when unknown
+            m_options.encoders = threads > 1 ? threads - 1 : 1;
+        }
+        m_options.queueDepth = (std::max)(m_options.queueDepth, std::size_t(1));
+        m_options.reorderDepth = (std::max)(m_options.reorderDepth, std::size_t(1));
+        m_options.render.maxPending = (std::max)(m_options.render.maxPending, std::size_t(1));
+        m_options.render.maxInFlight = (std::max)(m_options.render.maxInFlight, std::size_t(1));
+        if (m_options.render.pool && (m_options.render.pool == &WorkerPool::GetInstance() ||
+                                      m_options.render.pool->size() < convertThreads()))
+        {
+            throw AEException("Error Creating Frame Sequence Exporter. render.pool must be a dedicated pool with at "
+                              "least maxPending + maxInFlight threads");
+        }
+        m_options.pngCompression = (std::min)((std::max)(m_options.pngCompression, 0), 9);
+    }
+
+    FrameSequenceExporter(const FrameSequenceExporter &) = delete;
+    FrameSequenceExporter &operator=(const FrameSequenceExporter &) = delete;
+
+    /**
+     * @brief Exports frames first..last (inclusive) and blocks until they are written. Not on the main thread: the
+     * render stage runs there.
+     * @param onWritten Called on the writer thread after each frame is written, in frame order.
+     */
+    ExportStats run(A_long first, A_long last, const TimeBase &base, FrameWritten onWritten = FrameWritten())
+    {
+        if (IsMainThread())
+        {
+            throw AEException("Error Exporting Frames. run() blocks and must not be called on the main thread");
+        }
+        const auto start = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_running)
+            {
+                throw AEException("Error Exporting Frames. Export is already running");
+            }
+            m_running = true;
+            m_canceled = false;
+            m_producersDone = false;
+            m_nextWrite = first;
+            m_last = last;
+            m_encodeBacklog = 0;
+            m_encoded.clear();
+            m_failedFrames.clear();
+            m_stats = ExportStats();
+            m_stages = {};
+            m_onWritten = std::move(onWritten);
+        }
+        if (m_options.format == ExportFormat::Raw)
+        {
+            m_rawPath = pathOf(-1);
+            m_raw.open(m_rawPath, std::ios::binary | std::ios::trunc);
+            if (!m_raw)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_running = false;
+                throw AEException("Error Exporting Frames. Could not open " + m_rawPath);
+            }
+        }
+
+        stbi_write_png_compression_level = m_options.pngCompression; // stb reads the level from a global
+
+        // The pools join their threads when they go out of scope, after all their tasks ran.
+        RenderPipelineOptions renderSettings = m_options.render;
+        std::unique_ptr<WorkerPool> converters;
+        if (!renderSettings.pool)
+        {
+            converters = std::make_unique<WorkerPool>(static_cast<unsigned>(convertThreads()));
+            renderSettings.pool = converters.get();
+        }
+        WorkerPool writer(1);
+        WorkerPool encoders(m_options.encoders);
+        m_writer = &writer;
+        m_encoders = &encoders;
+
+        auto pipeline = RenderPipeline::create(
+            m_renderOptions, [this](const RenderedFrame &frame) { convert(frame); }, renderSettings);
+        pipeline->onFailure([this](A_long frame, bool) { fail(frame); });
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pipeline = pipeline;
+        }
+        RenderStats renderStats = pipeline->start(first, last, base).get();
+
+        // Every frame is now converted or failed; wait for the encoders, then let the writer flush the rest.
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_drained.wait(lock, [this] { return m_encodeBacklog == 0; });
+            m_producersDone = true;
+            m_pipeline.reset();
+        }
+        writer.submit([this] { drain(); }).get();
+
+        ExportStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+            m_writer = nullptr;
+            m_encoders = nullptr;
+            stats = m_stats;
+            stats.convert = m_stages.convert.stats(renderSettings.pool->size());
+            stats.encode = m_stages.encode.stats(m_options.encoders);
+            stats.write = m_stages.write.stats(1);
+        }
+        if (m_raw.is_open())
+        {
+            m_raw.close();
+        }
+        stats.render = renderStats;
+        stats.renderStage.frames = renderStats.completed;
+        stats.renderStage.workers = m_options.render.maxInFlight;
+        stats.renderStage.busyMs = renderStats.renderMsMean * (renderStats.completed + renderStats.failed);
+        stats.renderStage.activeMs = renderStats.elapsedMs;
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return stats;
+    }
+
+    /**
+     * @brief Stops rendering; frames already encoded are still written in order. run() returns soon after.
+     */
+    void cancel()
+    {
+        std::shared_ptr<RenderPipeline> pipeline;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_canceled = true;
+            pipeline = m_pipeline;
+        }
+        m_space.notify_all();
+        if (pipeline)
+        {
+            pipeline->cancel();
+        }
+    }
+
+    /**
+     * @brief The file a frame is written to (for Raw, the single stream file).
+     */
+    std::string pathOf(A_long frame) const
+    {
+        std::string path = m_options.directory;
+        if (!path.empty() && path.back() != '\\' && path.back() != '/')
+        {
+            path += '\\';
+        }
+        path += m_options.prefix;
+        switch (m_options.format)
+        {
+        case ExportFormat::Raw:
+            return path + ".raw";
+        case ExportFormat::TGA:
+            return path + padded(frame) + ".tga";
+        default:
+            return path + padded(frame) + ".png";
+        }
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Converted
+    {
+        A_long frame = 0;
+        int width = 0, height = 0;
+        std::vector<std::uint8_t> pixels; // RGBA rows, or PNG scanlines for 16 bit PNG
+    };
+
+    // Busy time and active span of one stage.
+    struct StageClock
+    {
+        std::size_t frames = 0;
+        double busyMs = 0.0;
+        Clock::time_point first, last;
+        bool started = false;
+
+        void add(Clock::time_point begin, Clock::time_point end)
+        {
+            ++frames;
+            busyMs += std::chrono::duration<double, std::milli>(end - begin).count();
+            first = started ? (std::min)(first, begin) : begin;
+            last = started ? (std::max)(last, end) : end;
+            started = true;
+        }
+
+        StageStats stats(std::size_t workers) const
+        {
+            StageStats result;
+            result.frames = frames;
+            result.workers = workers;
+            result.busyMs = busyMs;
+            result.activeMs = started ? std::chrono::duration<double, std::milli>(last - first).count() : 0.0;
+            return result;
+        }
+    };
+
+    struct Stages
+    {
+        StageClock convert, encode, write;
+    };
+
+    // Handlers the render stage can have running at once; convert() may block, so each needs its own thread.
+    std::size_t convertThreads() const { return m_options.render.maxPending + m_options.render.maxInFlight; }
+
+    std::string padded(A_long frame) const
+    {
+        std::string number = std::to_string(frame);
+        if (static_cast<int>(number.size()) < m_options.digits)
+        {
+            number.insert(0, m_options.digits - number.size(), '0');
+        }
+        return number;
+    }
+
+    // Convert stage, on a WorkerPool thread. Waiting here keeps the render stage's frames pending, which stops it
+    // from issuing more requests. The encoders never wait on anything, so the backlog always drains. The next frame
+    // to write is always inside the window, and convertThreads() guarantees it a thread, so the window always moves.
+    void convert(const RenderedFrame &frame)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_space.wait(lock, [this, &frame] {
+                return m_canceled || (m_encodeBacklog < m_options.queueDepth &&
+                                      frame.frame - m_nextWrite < static_cast<A_long>(m_options.reorderDepth));
+            });
+            if (m_canceled)
+            {
+                m_failedFrames.insert(frame.frame);
+                ++m_stats.failed;
+                return;
+            }
+            ++m_encodeBacklog;
+        }
+
+        const auto begin = Clock::now();
+        auto converted = std::make_shared<Converted>();
+        converted->frame = frame.frame;
+        converted->width = frame.width;
+        converted->height = frame.height;
+        try
+        {
+            UniformImage image(const_cast<void *>(frame.data), frame.width, frame.height, frame.bitDepth,
+                               frame.rowBytes);
+            if (m_options.format == ExportFormat::PNG && m_options.bitDepth == 16)
+            {
+                Image::png16Scanlines(image, converted->pixels);
+            }
+            else
+            {
+                Image::convert(image, m_options.bitDepth, converted->pixels);
+            }
+        }
+        catch (...)
+        {
+            encodeDone(frame.frame, nullptr, begin);
+            return;
+        }
+        const auto end = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stages.convert.add(begin, end);
+        }
+        m_encoders->post([this, converted] { encode(converted); });
+    }
+
+    // Encode stage, on an encoder thread.
+    void encode(const std::shared_ptr<Converted> &converted)
+    {
+        const auto begin = Clock::now();
+        auto encoded = std::make_shared<std::vector<std::uint8_t>>();
+        bool ok = true;
+        try
+        {
+            ok = encodeFrame(*converted, *encoded);
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+        encodeDone(converted->frame, ok ? encoded : nullptr, begin);
+    }
+
+    bool encodeFrame(Converted &converted, std::vector<std::uint8_t> &out) const
+    {
+        const int w = converted.width, h = converted.height;
+        switch (m_options.format)
+        {
+        case ExportFormat::Raw:
+            out.swap(converted.pixels);
+            return true;
+        case ExportFormat::TGA:
+            return stbi_write_tga_to_func(&FrameSequenceExporter::Append, &out, w, h, 4, converted.pixels.data()) != 0;
+        default:
+            if (m_options.bitDepth == 16)
+            {
+                return Image::encodePng16(converted.pixels, w, h, m_options.pngCompression, out);
+            }
+            return stbi_write_png_to_func(&FrameSequenceExporter::Append, &out, w, h, 4, converted.pixels.data(),
+                                          w * 4) != 0;
+        }
+    }
+
+    static void Append(void *context, void *data, int size)
+    {
+        auto *out = static_cast<std::vector<std::uint8_t> *>(context);
+        const auto *bytes = static_cast<const std::uint8_t *>(data);
+        out->insert(out->end(), bytes, bytes + size);
+    }
+
+    // Hands an encoded frame (or a failure, when encoded is null) to the writer.
+    void encodeDone(A_long frame, std::shared_ptr<std::vector<std::uint8_t>> encoded, Clock::time_point begin)
+    {
+        const auto end = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (encoded)
+            {
+                m_stages.encode.add(begin, end);
+                m_encoded.emplace(frame, std::move(encoded));
+            }
+            else
+            {
+                m_failedFrames.insert(frame);
+                ++m_stats.failed;
+            }
+            // Posted before the backlog drops, so run() cannot retire the writer in between.
+            m_writer->post([this] { drain(); });
+            --m_encodeBacklog;
+        }
+        m_space.notify_all(); // waiters wait on different frames
+        m_drained.notify_all();
+    }
+
+    // Render failures, from the render stage.
+    void fail(A_long frame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_failedFrames.insert(frame);
+            ++m_stats.failed;
+        }
+        m_writer->post([this] { drain(); });
+    }
+
+    // Write stage, on the single writer thread: writes every frame that is next in order.
+    void drain()
+    {
+        for (;;)
+        {
+            A_long frame = 0;
+            std::shared_ptr<std::vector<std::uint8_t>> encoded;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_nextWrite > m_last)
+                {
+                    return;
+                }
+                frame = m_nextWrite;
+                auto it = m_encoded.find(frame);
+                if (it != m_encoded.end())
+                {
+                    encoded = std::move(it->second);
+                    m_encoded.erase(it);
+                }
+                else if (!m_failedFrames.count(frame) && !m_producersDone)
+                {
+                    return; // still in an earlier stage
+                }
+                ++m_nextWrite; // failed, or never rendered because the export was canceled
+            }
+            m_space.notify_all(); // the reorder window moved
+            if (encoded)
+            {
+                write(frame, *encoded);
+            }
+        }
+    }
+
+    void write(A_long frame, const std::vector<std::uint8_t> &encoded)
+    {
+        const auto begin = Clock::now();
+        std::string path;
+        bool ok = false;
+        if (m_options.format == ExportFormat::Raw)
+        {
+            path = m_rawPath;
+            m_raw.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            ok = m_raw.good();
+        }
+        else
+        {
+            path = pathOf(frame);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            ok = file.good();
+        }
+        const auto end = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (ok)
+            {
+                m_stages.write.add(begin, end);
+                ++m_stats.written;
+            }
+            else
+            {
+                ++m_stats.failed;
+            }
+        }
+        if (ok && m_onWritten)
+        {
+            m_onWritten(frame, path);
+        }
+    }
+
+    LayerRenderOptionsPtr m_renderOptions;
+    Options m_options;
+
+    std::mutex m_mutex;
+    std::condition_variable m_space;   // encode backlog below queueDepth, reorder window moved, or canceled
+    std::condition_variable m_drained; // encode backlog changed
+    bool m_running = false;
+    bool m_canceled = false;
+    bool m_producersDone = false;
+    std::size_t m_encodeBacklog = 0; // frames converting or waiting for / inside an encoder
+    A_long m_nextWrite = 0;
+    A_long m_last = -1;
+    std::map<A_long, std::shared_ptr<std::vector<std::uint8_t>>> m_encoded; // waiting for an earlier frame
+    std::set<A_long> m_failedFrames;
+    ExportStats m_stats;
+    Stages m_stages;
+    std::shared_ptr<RenderPipeline> m_pipeline;
+    FrameWritten m_onWritten;
+
+    WorkerPool *m_writer = nullptr;   // valid while run() is active
+    WorkerPool *m_encoders = nullptr; // valid while run() is active
+    std::ofstream m_raw;              // writer thread only
+    std::string m_rawPath;
+};
+
+} // namespace ae
+
+#endif // FRAME_SEQUENCE_EXPORTER_HPP
@@ -14,6 +14,15 @@
 #include <stb_image_write.h>
 
 #include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/ImageView.hpp"
+#include "AETK/AEGP/Util/Swizzle.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 // Include library headers conditionally
 #ifdef USE_OPENCV
@@ -72,31 +81,19 @@ class Image
     static inline UniformImage data(WorldPtr mWorld)
     {
         if (!mWorld)
-		{
-			return UniformImage();
-		}
-        std::tuple<A_long, A_long> size = WorldSuite().getSize(mWorld);
-        auto rowbytes = WorldSuite().getRowBytes(mWorld);
-        void *baseAddr = nullptr;
-        int bitDepth = 8; // Default to 8, adjust based on actual data
-        switch (WorldSuite().getType(mWorld))
         {
-        case WorldType::NONE:
-            break;
-        case WorldType::W8:
-            baseAddr = WorldSuite().getBaseAddr8(mWorld);
-            break;
-        case WorldType::W16:
-            baseAddr = WorldSuite().getBaseAddr16(mWorld);
-            bitDepth = 16;
-            break;
-        case WorldType::W32:
-            baseAddr = WorldSuite().getBaseAddr32(mWorld);
-            bitDepth = 32;
-            break;
+            return UniformImage();
         }
-        return UniformImage(baseAddr, std::get<0>(size), std::get<1>(size), bitDepth, rowbytes);
+        return ae::visit_world(mWorld, [](auto view) { return uniform(view); });
+    }
+
+    // Describes a view's pixels as a UniformImage. Nothing is copied.
+    template <typename Pixel> static inline UniformImage uniform(const ae::ImageView<Pixel> &view)
+    {
+        return UniformImage(const_cast<std::remove_const_t<Pixel> *>(view.data()), view.width(), view.height(),
+                            ae::ImageView<Pixel>::BitDepth, static_cast<size_t>(view.rowBytes()));
     }
+
 // functions
 #ifdef USE_OPENCV
     cv::Mat toFormat() {}            // Implement conversion to cv::Mat
@@ -108,47 +105,214 @@ class Image
     UniformImage toUniformImage() {} // Implement conversion to UniformImage
 #endif
 
-    // New method to save the image using stb_image_write.h
+    /**
+     * @brief Converts img to tightly packed RGBA/BGRA rows at outBitDepth (8, 16 or 32 bits per channel).
+     *
+     * Honours img.rowPitch. out is resized, so passing the same vector for every frame avoids reallocating.
+     * 16 bit output is full range (0..65535).
+     */
+    static inline void convert(const UniformImage &img, int outBitDepth, std::vector<std::uint8_t> &out,
+                               ae::ChannelOrder order = ae::ChannelOrder::RGBA)
+    {
+        validate(img);
+        const std::size_t rowBytes = static_cast<std::size_t>(img.width) * 4 * (outBitDepth / 8);
+        out.resize(rowBytes * img.height);
+        ae::ConvertRows(img.data, pitchOf(img), img.bitDepth, out.data(), rowBytes, outBitDepth, img.width,
+                        img.height, order);
+    }
+
+    /**
+     * @brief Saves an ARGB image of any depth.
+     *
+     * - "png": 8 bit for 8 bpc images, 16 bit for 16 and 32 bpc images (floats clamped to 0..1)
+     * - "png8", "bmp", "tga": 8 bit
+     * - "hdr": Radiance float (alpha is dropped by the format)
+     *
+     * Conversion buffers are per thread and reused, so exporting frames from worker threads does not allocate
+     * per frame.
+     */
     static inline void saveImage(const std::string &filename, const std::string &format, UniformImage img)
     {
-        auto imageData = img; // Assume this returns your UniformImage type
-                              // with image data
-        int width = imageData.width;
-        int height = imageData.height;
-        int channels = 4; // Assuming ARGB format (4 channels)
+        validate(img);
+        auto &scratch = Scratch();
+        int written = 0;
+        if (format == "hdr")
+        {
+            convert(img, 32, scratch);
+            written = stbi_write_hdr(filename.c_str(), img.width, img.height, 4,
+                                     reinterpret_cast<const float *>(scratch.data()));
+        }
+        else if (format == "png" && img.bitDepth > 8)
+        {
+            written = writePng16(filename, img);
+        }
+        else if (format == "png" || format == "png8" || format == "bmp" || format == "tga")
+        {
+            convert(img, 8, scratch);
+            if (format == "bmp")
+            {
+                written = stbi_write_bmp(filename.c_str(), img.width, img.height, 4, scratch.data());
+            }
+            else if (format == "tga")
+            {
+                written = stbi_write_tga(filename.c_str(), img.width, img.height, 4, scratch.data());
+            }
+            else
+            {
+                written = stbi_write_png(filename.c_str(), img.width, img.height, 4, scratch.data(), img.width * 4);
+            }
+        }
+        else
+        {
+            throw AEException("Error Saving Image. Unsupported format " + format);
+        }
+        if (!written)
+        {
+            throw AEException("Error Saving Image. Could not write " + filename);
+        }
+    }
+
+    // Saves a view (or subview) of a world; see saveImage above for the formats.
+    template <typename Pixel>
+    static inline void saveImage(const std::string &filename, const std::string &format,
+                                 const ae::ImageView<Pixel> &view)
+    {
+        saveImage(filename, format, uniform(view));
+    }
 
-        // Convert ARGB to RGBA
-        unsigned char *rgba = new unsigned char[width * height * channels];
-        unsigned char *argb =
-            static_cast<unsigned char *>(imageData.data); // Assuming imageData.data is your raw ARGB data
+    /**
+     * @brief Fills scanlines with img as PNG expects it at 16 bits: per row one filter byte (none), then big-endian
+     * full range RGBA samples.
+     */
+    static inline void png16Scanlines(const UniformImage &img, std::vector<std::uint8_t> &scanlines)
+    {
+        validate(img);
+        const std::size_t rowBytes = static_cast<std::size_t>(img.width) * 8;
+        scanlines.resize((rowBytes + 1) * img.height);
+        for (int y = 0; y < img.height; ++y)
+        {
+            scanlines[y * (rowBytes + 1)] = 0;
+        }
+        ae::ConvertRows(img.data, pitchOf(img), img.bitDepth, scanlines.data() + 1, rowBytes + 1, 16, img.width,
+                        img.height, ae::ChannelOrder::RGBA, true);
+    }
 
-        for (int i = 0; i < width * height; ++i)
+    /**
+     * @brief Encodes scanlines from png16Scanlines as a 16 bit RGBA PNG into out. stb_image_write only writes 8 bit
+     * PNGs, so this wraps stb's deflate in the PNG chunks itself.
+     * @param level zlib compression level (stbi_write_png_compression_level for stb's default).
+     */
+    static inline bool encodePng16(const std::vector<std::uint8_t> &scanlines, int width, int height, int level,
+                                   std::vector<std::uint8_t> &out)
+    {
+        int compressedSize = 0;
+        unsigned char *compressed = stbi_zlib_compress(const_cast<unsigned char *>(scanlines.data()),
+                                                       static_cast<int>(scanlines.size()), &compressedSize, level);
+        if (!compressed)
         {
-            rgba[i * 4 + 0] = argb[i * 4 + 1]; // R
-            rgba[i * 4 + 1] = argb[i * 4 + 2]; // G
-            rgba[i * 4 + 2] = argb[i * 4 + 3]; // B
-            rgba[i * 4 + 3] = argb[i * 4 + 0]; // A (moved from the first to the last position)
+            return false;
         }
+        static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.assign(signature, signature + sizeof(signature));
+        std::uint8_t header[13] = {};
+        putBigEndian(header, static_cast<std::uint32_t>(width));
+        putBigEndian(header + 4, static_cast<std::uint32_t>(height));
+        header[8] = 16; // bit depth
+        header[9] = 6;  // colour type: RGBA
+        appendPngChunk(out, "IHDR", header, sizeof(header));
+        appendPngChunk(out, "IDAT", compressed, static_cast<std::uint32_t>(compressedSize));
+        appendPngChunk(out, "IEND", nullptr, 0);
+        STBIW_FREE(compressed);
+        return true;
+    }
 
-        // Save the image
-        if (format == "png")
+  private:
+    static inline void validate(const UniformImage &img)
+    {
+        CheckNotNull(img.data, "Error Converting Image. Image data is Null");
+        if (img.width <= 0 || img.height <= 0)
         {
-            stbi_write_png(filename.c_str(), width, height, channels, rgba, width * channels);
+            throw AEException("Error Converting Image. Image is empty");
         }
-        else if (format == "bmp")
+        if (img.bitDepth != 8 && img.bitDepth != 16 && img.bitDepth != 32)
+        {
+            throw AEException("Error Converting Image. Bit depth must be 8, 16 or 32");
+        }
+    }
+
+    // Row pitch, or packed rows when the image does not say.
+    static inline std::size_t pitchOf(const UniformImage &img)
+    {
+        return img.rowPitch ? img.rowPitch : static_cast<std::size_t>(img.width) * 4 * (img.bitDepth / 8);
+    }
+
+    static inline std::vector<std::uint8_t> &Scratch()
+    {
+        thread_local std::vector<std::uint8_t> scratch;
+        return scratch;
+    }
+
+    static inline int writePng16(const std::string &filename, const UniformImage &img)
+    {
+        auto &scanlines = Scratch();
+        png16Scanlines(img, scanlines);
+        std::vector<std::uint8_t> encoded;
+        if (!encodePng16(scanlines, img.width, img.height, stbi_write_png_compression_level, encoded))
         {
-            stbi_write_bmp(filename.c_str(), width, height, channels, rgba);
+            return 0;
         }
-        else if (format == "tga")
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        return file.good() ? 1 : 0;
+    }
+
+    static inline void putBigEndian(std::uint8_t *out, std::uint32_t value)
+    {
+        out[0] = static_cast<std::uint8_t>(value >> 24);
+        out[1] = static_cast<std::uint8_t>(value >> 16);
+        out[2] = static_cast<std::uint8_t>(value >> 8);
+        out[3] = static_cast<std::uint8_t>(value);
+    }
+
+    static inline std::uint32_t crc32(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+    {
+        static const auto table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t n = 0; n < 256; ++n)
+            {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[n] = c;
+            }
+            return t;
+        }();
+        for (std::size_t i = 0; i < size; ++i)
         {
-            stbi_write_tga(filename.c_str(), width, height, channels, rgba);
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
         }
+        return crc;
+    }
 
-        // Cleanup
-        delete[] rgba;
+    static inline void appendPngChunk(std::vector<std::uint8_t> &out, const char *type, const std::uint8_t *data,
+                                      std::uint32_t size)
+    {
+        std::uint8_t word[4];
+        putBigEndian(word, size);
+        out.insert(out.end(), word, word + 4);
+        out.insert(out.end(), type, type + 4);
+        std::uint32_t crc = crc32(0xFFFFFFFFu, reinterpret_cast<const std::uint8_t *>(type), 4);
+        if (size)
+        {
+            out.insert(out.end(), data, data + size);
+            crc = crc32(crc, data, size);
+        }
+        putBigEndian(word, crc ^ 0xFFFFFFFFu);
+        out.insert(out.end(), word, word + 4);
     }
 
-  private:
     WorldPtr mWorld;
 };
 
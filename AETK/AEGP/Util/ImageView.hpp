@@ -0,0 +1,268 @@
+/*****************************************************************/ /**
+                                                                     * \file   ImageView.hpp
+                                                                     * \brief  Typed, non-owning views of ARGB pixels
+                                                                     *in AE worlds.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef IMAGE_VIEW_HPP
+#define IMAGE_VIEW_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+
+#include <AE_EffectPixelFormat.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+namespace ae
+{
+
+/**
+ * @brief Channel type and bit depth of an AE pixel type.
+ */
+template <typename Pixel> struct PixelTraits;
+
+template <> struct PixelTraits<PF_Pixel8>
+{
+    using Channel = A_u_char;
+    static constexpr int BitDepth = 8;
+};
+
+template <> struct PixelTraits<PF_Pixel16>
+{
+    using Channel = A_u_short;
+    static constexpr int BitDepth = 16;
+};
+
+template <> struct PixelTraits<PF_PixelFloat>
+{
+    using Channel = PF_FpShort;
+    static constexpr int BitDepth = 32;
+};
+
+template <typename Pixel> struct PixelTraits<const Pixel> : PixelTraits<Pixel>
+{
+};
+
+/**
+ * @brief One row of an ImageView, usable in range-for loops.
+ */
+template <typename Pixel> class RowSpan
+{
+  public:
+    RowSpan(Pixel *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    Pixel *begin() const { return m_data; }
+    Pixel *end() const { return m_data + m_size; }
+    Pixel *data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    Pixel &operator[](std::size_t x) const { return m_data[x]; }
+
+  private:
+    Pixel *m_data;
+    std::size_t m_size;
+};
+
+/**
+ * @class ImageView
+ * @brief A width x height window of ARGB pixels with a row pitch in bytes. Never owns or copies pixels.
+ *
+ * Pixel is PF_Pixel8, PF_Pixel16 or PF_PixelFloat, optionally const. A view is only valid while the world (or frame
+ * receipt) it was made from is alive.
+ *
+ * @example
+ * ae::visit_world(world, [](auto view) {
+ *     for (A_long y = 0; y < view.height(); ++y)
+ *         for (auto &pixel : view.row(y))
+ *             pixel.alpha = 0;
+ * });
+ */
+template <typename Pixel> class ImageView
+{
+  public:
+    using PixelType = Pixel;
+    using Channel = typename PixelTraits<Pixel>::Channel;
+    static constexpr int BitDepth = PixelTraits<Pixel>::BitDepth;
+
+    ImageView() = default;
+
+    ImageView(Pixel *data, A_long width, A_long height, std::ptrdiff_t rowBytes)
+        : m_data(data), m_width(width), m_height(height), m_rowBytes(rowBytes)
+    {
+        if (width < 0 || height < 0 || (height > 1 && std::abs(rowBytes) < std::ptrdiff_t(width * sizeof(Pixel))))
+        {
+            throw AEException("Error Creating Image View. Rows are shorter than the width");
+        }
+    }
+
+    /**
+     * @brief Views an effect world. Pixel must match the world's format (PF_WORLD_IS_DEEP is checked for 8 and 16
+     * bits; float worlds cannot be told apart from the world alone).
+     */
+    explicit ImageView(const PF_EffectWorld &world)
+        : ImageView(reinterpret_cast<Pixel *>(world.data), world.width, world.height, world.rowbytes)
+    {
+        const bool deep = (world.world_flags & PF_WorldFlag_DEEP) != 0;
+        if ((BitDepth == 8 && deep) || (BitDepth == 16 && !deep))
+        {
+            throw AEException("Error Creating Image View. Pixel type does not match the world's bit depth");
+        }
+    }
+
+    // A view of mutable pixels converts to a view of const pixels.
+    template <typename Other, typename = std::enable_if_t<std::is_same<const Other, Pixel>::value>>
+    ImageView(const ImageView<Other> &other)
+        : m_data(other.data()), m_width(other.width()), m_height(other.height()), m_rowBytes(other.rowBytes())
+    {
+    }
+
+    Pixel *data() const { return m_data; }
+    A_long width() const { return m_width; }
+    A_long height() const { return m_height; }
+    std::ptrdiff_t rowBytes() const { return m_rowBytes; }
+    bool empty() const { return !m_data || m_width == 0 || m_height == 0; }
+
+    // True when rows follow each other without padding.
+    bool contiguous() const { return m_rowBytes == std::ptrdiff_t(m_width * sizeof(Pixel)); }
+
+    Pixel *rowData(A_long y) const
+    {
+        using Byte = std::conditional_t<std::is_const<Pixel>::value, const std::uint8_t, std::uint8_t>;
+        return reinterpret_cast<Pixel *>(reinterpret_cast<Byte *>(m_data) + y * m_rowBytes);
+    }
+
+    RowSpan<Pixel> row(A_long y) const { return RowSpan<Pixel>(rowData(y), static_cast<std::size_t>(m_width)); }
+
+    Pixel &operator()(A_long x, A_long y) const { return rowData(y)[x]; }
+
+    /**
+     * @brief The region starting at (x, y), sharing this view's pixels and row pitch.
+     */
+    ImageView subview(A_long x, A_long y, A_long width, A_long height) const
+    {
+        if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > m_width || y + height > m_height)
+        {
+            throw AEException("Error Creating Image Subview. Region is outside the image");
+        }
+        return ImageView(rowData(y) + x, width, height, m_rowBytes);
+    }
+
+  private:
+    Pixel *m_data = nullptr;
+    A_long m_width = 0;
+    A_long m_height = 0;
+    std::ptrdiff_t m_rowBytes = 0;
+};
+
+using ImageView8 = ImageView<PF_Pixel8>;
+using ImageView16 = ImageView<PF_Pixel16>;
+using ImageViewFloat = ImageView<PF_PixelFloat>;
+
+/**
+ * @brief Calls func with an ImageView of the type matching bitDepth (8, 16 or 32).
+ */
+template <typename Func>
+decltype(auto) visit_pixels(void *data, int bitDepth, A_long width, A_long height, std::ptrdiff_t rowBytes,
+                            Func &&func)
+{
+    switch (bitDepth)
+    {
+    case 8:
+        return func(ImageView8(static_cast<PF_Pixel8 *>(data), width, height, rowBytes));
+    case 16:
+        return func(ImageView16(static_cast<PF_Pixel16 *>(data), width, height, rowBytes));
+    case 32:
+        return func(ImageViewFloat(static_cast<PF_PixelFloat *>(data), width, height, rowBytes));
+    default:
+        throw AEException("Error Visiting Pixels. Bit depth must be 8, 16 or 32");
+    }
+}
+
+/**
+ * @brief Calls func with a view of an AEGP world, typed by the world's depth. func is instantiated for all three
+ * pixel types, so it is usually a generic lambda.
+ *
+ * The world's layout is read in one main-thread task; func itself runs on the calling thread.
+ */
+template <typename Func> decltype(auto) visit_world(const WorldPtr &world, Func &&func)
+{
+    CheckNotNull(world.get(), "Error Visiting World. World is Null");
+    struct Layout
+    {
+        void *data = nullptr;
+        int bitDepth = 0;
+        A_long width = 0, height = 0;
+        A_u_long rowBytes = 0;
+    };
+    const Layout layout = ScheduleOrExecute([world]() {
+                              auto *suite = SuiteManager::GetInstance().GetSuiteHandler().WorldSuite3();
+                              AEGP_WorldH handle = world->get();
+                              Layout result;
+                              AEGP_WorldType type = AEGP_WorldType_NONE;
+                              AE_CHECK(suite->AEGP_GetType(handle, &type));
+                              AE_CHECK(suite->AEGP_GetSize(handle, &result.width, &result.height));
+                              AE_CHECK(suite->AEGP_GetRowBytes(handle, &result.rowBytes));
+                              switch (type)
+                              {
+                              case AEGP_WorldType_8: {
+                                  PF_Pixel8 *base = nullptr;
+                                  AE_CHECK(suite->AEGP_GetBaseAddr8(handle, &base));
+                                  result.data = base;
+                                  result.bitDepth = 8;
+                                  break;
+                              }
+                              case AEGP_WorldType_16: {
+                                  PF_Pixel16 *base = nullptr;
+                                  AE_CHECK(suite->AEGP_GetBaseAddr16(handle, &base));
+                                  result.data = base;
+                                  result.bitDepth = 16;
+                                  break;
+                              }
+                              case AEGP_WorldType_32: {
+                                  PF_PixelFloat *base = nullptr;
+                                  AE_CHECK(suite->AEGP_GetBaseAddr32(handle, &base));
+                                  result.data = base;
+                                  result.bitDepth = 32;
+                                  break;
+                              }
+                              default:
+                                  throw AEException("Error Visiting World. World has no pixels");
+                              }
+                              return result;
+                          })
+                              .get();
+    return visit_pixels(layout.data, layout.bitDepth, layout.width, layout.height,
+                        static_cast<std::ptrdiff_t>(layout.rowBytes), std::forward<Func>(func));
+}
+
+/**
+ * @brief Calls func with a view of an effect world in the given pixel format
+ * (PF_PixelFormat_ARGB32, ARGB64 or ARGB128, as reported by PF_WorldSuite2::PF_GetPixelFormat).
+ */
+template <typename Func> decltype(auto) visit_world(const PF_EffectWorld &world, PF_PixelFormat format, Func &&func)
+{
+    int bitDepth = 0;
+    switch (format)
+    {
+    case PF_PixelFormat_ARGB32:
+        bitDepth = 8;
+        break;
+    case PF_PixelFormat_ARGB64:
+        bitDepth = 16;
+        break;
+    case PF_PixelFormat_ARGB128:
+        bitDepth = 32;
+        break;
+    default:
+        throw AEException("Error Visiting World. Only ARGB pixel formats can be viewed");
+    }
+    return visit_pixels(world.data, bitDepth, world.width, world.height, world.rowbytes, std::forward<Func>(func));
+}
+
+} // namespace ae
+
+#endif // IMAGE_VIEW_HPP
@@ -10,6 +10,11 @@
 
 #include "AETK/AEGP/Core/Types.hpp"
 
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+
 /**
  * @class KeyFrame
  * @brief Represents a keyframe in After Effects.
@@ -221,8 +226,7 @@ class KeyFrame
         return os.str();
     }
 
-  private:
-    std::string toInterpString(KeyInterp interp) const
+    static const char *toInterpString(KeyInterp interp)
     {
         switch (interp)
         {
@@ -237,7 +241,7 @@ class KeyFrame
         }
     }
 
-    std::string toFlagString(KeyframeFlag flag) const
+    static const char *toFlagString(KeyframeFlag flag)
     {
         switch (flag)
         {
@@ -257,5 +261,330 @@ class KeyFrame
     }
 };
 
+/**
+ * @class PackedKeyframe
+ * @brief Fixed-size keyframe for a stream with Dim value components (1D = 1, 2D = 2, 3D = 3, color = 4).
+ *
+ * KeyFrame allocates its flag vector on the heap and carries optionals and variants for every field, which adds up
+ * for large tracks. PackedKeyframe stores the same data inline: flags as a bitmask, interpolation as two bytes, and
+ * value and tangents as Dim doubles each. It never allocates, so a tk::vector<PackedKeyframe<Dim>> is one block.
+ *
+ * Use fromKeyFrame / toKeyFrame to convert to and from KeyFrame. Fields that are unset in the KeyFrame are recorded
+ * in a presence mask, so a round trip gives back the same KeyFrame.
+ */
+template <int Dim> class PackedKeyframe
+{
+    static_assert(Dim >= 1 && Dim <= 4, "PackedKeyframe supports 1 to 4 value components");
+
+  public:
+    using Components = std::array<double, Dim>;
+
+    enum Present : std::uint8_t
+    {
+        HasValue = 0x01,
+        HasInterp = 0x02,
+        HasEaseIn = 0x04,
+        HasEaseOut = 0x08,
+        HasTangents = 0x10
+    };
+
+    double time = 0.0;
+    Components value{};
+    Components inTangent{};
+    Components outTangent{};
+    AEGP_KeyframeEase easeIn{0.0, 0.0};
+    AEGP_KeyframeEase easeOut{0.0, 0.0};
+    std::uint8_t flags = 0;    // KeyframeFlag bits
+    std::uint8_t inInterp = 0; // KeyInterp
+    std::uint8_t outInterp = 0;
+    std::uint8_t present = 0; // Present bits
+
+    PackedKeyframe() = default;
+    explicit PackedKeyframe(double time) : time(time) {}
+    PackedKeyframe(double time, const Components &value) : time(time), value(value), present(HasValue) {}
+
+    bool has(Present field) const { return (present & field) != 0; }
+
+    bool hasFlag(KeyframeFlag flag) const { return (flags & static_cast<int>(flag)) != 0; }
+
+    PackedKeyframe &setFlag(KeyframeFlag flag, bool enable = true)
+    {
+        flags = static_cast<std::uint8_t>(enable ? flags | static_cast<int>(flag) : flags & ~static_cast<int>(flag));
+        return *this;
+    }
+
+    PackedKeyframe &setValue(const Components &components)
+    {
+        value = components;
+        present |= HasValue;
+        return *this;
+    }
+
+    PackedKeyframe &setInterpolation(KeyInterp in, KeyInterp out)
+    {
+        inInterp = static_cast<std::uint8_t>(in);
+        outInterp = static_cast<std::uint8_t>(out);
+        present |= HasInterp;
+        return *this;
+    }
+
+    PackedKeyframe &setEaseIn(double speed, double influence)
+    {
+        easeIn = AEGP_KeyframeEase{speed, influence};
+        present |= HasEaseIn;
+        return *this;
+    }
+
+    PackedKeyframe &setEaseOut(double speed, double influence)
+    {
+        easeOut = AEGP_KeyframeEase{speed, influence};
+        present |= HasEaseOut;
+        return *this;
+    }
+
+    PackedKeyframe &setTangents(const Components &in, const Components &out)
+    {
+        inTangent = in;
+        outTangent = out;
+        present |= HasTangents;
+        return *this;
+    }
+
+    KeyInterp interpIn() const { return static_cast<KeyInterp>(inInterp); }
+    KeyInterp interpOut() const { return static_cast<KeyInterp>(outInterp); }
+
+    /**
+     * @brief Packs a KeyFrame. Values whose type does not match Dim are left unset.
+     */
+    static PackedKeyframe fromKeyFrame(const KeyFrame &keyframe)
+    {
+        PackedKeyframe packed(keyframe.time);
+        if (unpack(keyframe.value, packed.value))
+        {
+            packed.present |= HasValue;
+        }
+        for (KeyframeFlag flag : keyframe.flags)
+        {
+            packed.setFlag(flag);
+        }
+        if (keyframe.interp)
+        {
+            packed.setInterpolation(keyframe.interp->first, keyframe.interp->second);
+        }
+        if (keyframe.easeIn)
+        {
+            packed.setEaseIn(keyframe.easeIn->speedF, keyframe.easeIn->influenceF);
+        }
+        if (keyframe.easeOut)
+        {
+            packed.setEaseOut(keyframe.easeOut->speedF, keyframe.easeOut->influenceF);
+        }
+        if (keyframe.tangents && unpack(keyframe.tangents->first, packed.inTangent) &&
+            unpack(keyframe.tangents->second, packed.outTangent))
+        {
+            packed.present |= HasTangents;
+        }
+        return packed;
+    }
+
+    KeyFrame toKeyFrame() const
+    {
+        KeyFrame keyframe(time);
+        if (has(HasValue))
+        {
+            keyframe.setValue(pack(value));
+        }
+        for (int bit = static_cast<int>(KeyframeFlag::TEMPORAL_CONTINUOUS);
+             bit <= static_cast<int>(KeyframeFlag::ROVING); bit <<= 1)
+        {
+            if (flags & bit)
+            {
+                keyframe.setFlag(static_cast<KeyframeFlag>(bit));
+            }
+        }
+        if (has(HasInterp))
+        {
+            keyframe.setInterpolation(interpIn(), interpOut());
+        }
+        if (has(HasEaseIn))
+        {
+            keyframe.setEaseIn(easeIn.speedF, easeIn.influenceF);
+        }
+        if (has(HasEaseOut))
+        {
+            keyframe.setEaseOut(easeOut.speedF, easeOut.influenceF);
+        }
+        if (has(HasTangents))
+        {
+            keyframe.tangents.emplace(pack(inTangent), pack(outTangent));
+        }
+        return keyframe;
+    }
+
+    /**
+     * @brief Appends the same text as KeyFrame::toString to out, without a stream or temporary strings.
+     */
+    void appendTo(std::string &out) const
+    {
+        out += "Time: ";
+        appendNumber(out, time);
+        out += "\nValue: ";
+        if (has(HasValue))
+        {
+            appendComponents(out, value);
+        }
+        else
+        {
+            out += "none";
+        }
+        out += '\n';
+        if (has(HasInterp))
+        {
+            out += "Interpolation: In - ";
+            out += KeyFrame::toInterpString(interpIn());
+            out += ", Out - ";
+            out += KeyFrame::toInterpString(interpOut());
+            out += '\n';
+        }
+        if (flags)
+        {
+            out += "Flags: ";
+            for (int bit = static_cast<int>(KeyframeFlag::TEMPORAL_CONTINUOUS);
+                 bit <= static_cast<int>(KeyframeFlag::ROVING); bit <<= 1)
+            {
+                if (flags & bit)
+                {
+                    out += KeyFrame::toFlagString(static_cast<KeyframeFlag>(bit));
+                    out += ' ';
+                }
+            }
+            out += '\n';
+        }
+        appendEase(out, "Ease In", easeIn, HasEaseIn);
+        appendEase(out, "Ease Out", easeOut, HasEaseOut);
+        if (has(HasTangents))
+        {
+            out += "Tangents: In - ";
+            appendComponents(out, inTangent);
+            out += ", Out - ";
+            appendComponents(out, outTangent);
+            out += '\n';
+        }
+    }
+
+    std::string toString() const
+    {
+        std::string out;
+        appendTo(out);
+        return out;
+    }
+
+  private:
+    static bool unpack(const KeyFrame::TangentValue &source, Components &out)
+    {
+        if constexpr (Dim == 1)
+        {
+            if (auto *v = std::get_if<double>(&source))
+            {
+                out[0] = *v;
+                return true;
+            }
+        }
+        else if constexpr (Dim == 2)
+        {
+            if (auto *v = std::get_if<TwoDVal>(&source))
+            {
+                out = {v->x, v->y};
+                return true;
+            }
+        }
+        else if constexpr (Dim == 3)
+        {
+            if (auto *v = std::get_if<ThreeDVal>(&source))
+            {
+                out = {v->x, v->y, v->z};
+                return true;
+            }
+        }
+        else
+        {
+            if (auto *v = std::get_if<ColorVal>(&source))
+            {
+                out = {v->red, v->green, v->blue, v->alpha};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static KeyFrame::TangentValue pack(const Components &c)
+    {
+        if constexpr (Dim == 1)
+        {
+            return c[0];
+        }
+        else if constexpr (Dim == 2)
+        {
+            return TwoDVal(c[0], c[1]);
+        }
+        else if constexpr (Dim == 3)
+        {
+            return ThreeDVal(c[0], c[1], c[2]);
+        }
+        else
+        {
+            return ColorVal(c[0], c[1], c[2], c[3]);
+        }
+    }
+
+    // Formats like an ostream with default flags (%g, 6 significant digits), so the text matches KeyFrame::toString.
+    static void appendNumber(std::string &out, double number)
+    {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::general, 6);
+        out.append(buffer, result.ptr);
+    }
+
+    static void appendComponents(std::string &out, const Components &c)
+    {
+        if constexpr (Dim == 1)
+        {
+            appendNumber(out, c[0]);
+        }
+        else
+        {
+            out += '(';
+            for (int d = 0; d < Dim; ++d)
+            {
+                if (d > 0)
+                {
+                    out += ", ";
+                }
+                appendNumber(out, c[d]);
+            }
+            out += ')';
+        }
+    }
+
+    void appendEase(std::string &out, const char *label, const AEGP_KeyframeEase &ease, Present field) const
+    {
+        if (!has(field))
+        {
+            return;
+        }
+        out += label;
+        out += ": Speed - ";
+        appendNumber(out, ease.speedF);
+        out += ", Influence - ";
+        appendNumber(out, ease.influenceF);
+        out += '\n';
+    }
+};
+
+using PackedKeyframe1D = PackedKeyframe<1>;
+using PackedKeyframe2D = PackedKeyframe<2>;
+using PackedKeyframe3D = PackedKeyframe<3>;
+using PackedKeyframeColor = PackedKeyframe<4>;
+
 #endif
 // KEYFRAME_HPP
\ No newline at end of file
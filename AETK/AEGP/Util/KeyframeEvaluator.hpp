@@ -0,0 +1,426 @@
+/*****************************************************************/ /**
+                                                                     * \file   KeyframeEvaluator.hpp
+                                                                     * \brief  Evaluates a KeyframeTrack locally,
+                                                                     *without host calls.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef KEYFRAME_EVALUATOR_HPP
+#define KEYFRAME_EVALUATOR_HPP
+
+#include "AETK/AEGP/Util/KeyframeTrack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class KeyframeEvaluator
+ * @brief Reproduces After Effects' keyframe interpolation from a KeyframeTrack.
+ *
+ * Reading a property value at a time costs a main-thread round trip. The evaluator does the same work in plain
+ * C++: read the track once (KeyframeTrack::read), then evaluate as many times as needed on any thread.
+ *
+ * Supported interpolation:
+ * - hold: the value of the previous key
+ * - linear: constant speed between keys
+ * - temporal bezier: speed / influence ease, one curve per temporal dimension
+ * - spatial bezier: 2D / 3D spatial streams follow the cubic path given by the key tangents, at a speed set by the
+ *   temporal ease and measured along the path (arc length)
+ *
+ * When a segment mixes linear and bezier, the linear side is treated as a handle at one third of the segment with
+ * the segment's average speed, so two linear sides give exactly linear motion. Expressions, and the "rove in time"
+ * flag, are not evaluated; roving keys are taken at their stored times.
+ *
+ * Evaluation is const and allocates nothing, so one evaluator can be shared by many threads.
+ *
+ * @example
+ * auto evaluator = std::make_shared<ae::KeyframeEvaluator>(layer->Position()->getKeyframeTrack());
+ * auto future = ae::WorkerPool::GetInstance().submit([evaluator, base] {
+ *     std::vector<std::array<double, 4>> curve;
+ *     for (int frame = 0; frame < 240; ++frame)
+ *         curve.push_back(evaluator->evaluate(base.timeToSeconds(base.framesToTime(frame))));
+ *     return curve;
+ * });
+ */
+class KeyframeEvaluator
+{
+  public:
+    static constexpr int MaxDimensions = KeyframeTrack::MaxDimensions;
+    using Value = std::array<double, MaxDimensions>;
+
+    /**
+     * @param track The keys to evaluate. Only tracks with values (1D, 2D, 3D and color streams) are supported.
+     * @param pathSamples Samples per spatial segment in the arc-length table.
+     */
+    explicit KeyframeEvaluator(KeyframeTrack track, int pathSamples = 64)
+        : m_track(std::move(track)), m_pathSamples((std::max)(pathSamples, 2))
+    {
+        if (m_track.dimensions == 0 && !m_track.empty())
+        {
+            throw AEException("Error Creating Keyframe Evaluator. Stream type has no values to interpolate");
+        }
+        build();
+    }
+
+    const KeyframeTrack &track() const { return m_track; }
+
+    int dimensions() const { return m_track.dimensions; }
+
+    /**
+     * @brief Writes the value at a comp time (seconds) to out, one entry per dimension.
+     */
+    void evaluate(double seconds, double *out) const
+    {
+        const std::size_t count = m_seconds.size();
+        if (count == 0)
+        {
+            throw AEException("Error Evaluating Keyframes. Track has no keys");
+        }
+        if (count == 1 || seconds <= m_seconds.front())
+        {
+            keyValue(0, out);
+            return;
+        }
+        if (seconds >= m_seconds.back())
+        {
+            keyValue(count - 1, out);
+            return;
+        }
+
+        const auto next = std::upper_bound(m_seconds.begin(), m_seconds.end(), seconds);
+        const std::size_t key = static_cast<std::size_t>(next - m_seconds.begin()) - 1;
+        const Segment &segment = m_segments[key];
+        if (segment.kind == Kind::Hold)
+        {
+            keyValue(key, out);
+            return;
+        }
+
+        const double x = (seconds - m_seconds[key]) / (m_seconds[key + 1] - m_seconds[key]);
+        const Curve *curves = &m_curves[key * m_curvesPerSegment];
+        const int dims = m_track.dimensions;
+
+        if (!m_pathMode)
+        {
+            for (int d = 0; d < dims; ++d)
+            {
+                out[d] = m_track.values[d][key] + curves[d].at(x, segment.kind);
+            }
+            return;
+        }
+
+        if (segment.length <= 0.0)
+        {
+            keyValue(key, out);
+            return;
+        }
+        const double distance = curves[0].at(x, segment.kind);
+        if (segment.lut == NoPath)
+        {
+            const double t = distance / segment.length;
+            for (int d = 0; d < dims; ++d)
+            {
+                const double v0 = m_track.values[d][key];
+                out[d] = v0 + (m_track.values[d][key + 1] - v0) * t;
+            }
+            return;
+        }
+        pathPoint(key, pathParameter(segment, distance), out);
+    }
+
+    Value evaluate(double seconds) const
+    {
+        Value value{};
+        evaluate(seconds, value.data());
+        return value;
+    }
+
+    /**
+     * @brief Evaluates count times; out receives count * dimensions() values, interleaved by key.
+     */
+    void evaluate(const double *seconds, std::size_t count, double *out) const
+    {
+        const int dims = m_track.dimensions;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            evaluate(seconds[i], out + i * dims);
+        }
+    }
+
+  private:
+    enum class Kind : std::uint8_t
+    {
+        Hold,
+        Linear,
+        Bezier
+    };
+
+    static constexpr std::size_t NoPath = static_cast<std::size_t>(-1);
+
+    /**
+     * One eased channel of a segment: a cubic bezier from (0, 0) to (1, delta) in normalised time.
+     */
+    struct Curve
+    {
+        double x1 = 1.0 / 3.0, y1 = 0.0, x2 = 2.0 / 3.0, y2 = 0.0, delta = 0.0;
+
+        double at(double x, Kind kind) const
+        {
+            if (kind == Kind::Linear)
+            {
+                return delta * x;
+            }
+            const double u = solve(x);
+            const double v = 1.0 - u;
+            return 3.0 * v * v * u * y1 + 3.0 * v * u * u * y2 + u * u * u * delta;
+        }
+
+        // Finds u with bezierX(u) == x. bezierX is monotonic because AE keeps in + out influence <= 100%.
+        double solve(double x) const
+        {
+            double u = x;
+            for (int i = 0; i < 8; ++i)
+            {
+                const double error = bezierX(u) - x;
+                if (std::abs(error) < 1e-9)
+                {
+                    return u;
+                }
+                const double slope = bezierSlope(u);
+                if (std::abs(slope) < 1e-9)
+                {
+                    break;
+                }
+                u = std::clamp(u - error / slope, 0.0, 1.0);
+            }
+            double lo = 0.0, hi = 1.0;
+            u = x;
+            for (int i = 0; i < 40; ++i)
+            {
+                if (bezierX(u) < x)
+                {
+                    lo = u;
+                }
+                else
+                {
+                    hi = u;
+                }
+                u = 0.5 * (lo + hi);
+            }
+            return u;
+        }
+
+        double bezierX(double u) const
+        {
+            const double v = 1.0 - u;
+            return 3.0 * v * v * u * x1 + 3.0 * v * u * u * x2 + u * u * u;
+        }
+
+        double bezierSlope(double u) const
+        {
+            const double v = 1.0 - u;
+            return 3.0 * v * v * x1 + 6.0 * v * u * (x2 - x1) + 3.0 * u * u * (1.0 - x2);
+        }
+    };
+
+    struct Segment
+    {
+        Kind kind = Kind::Linear;
+        double length = 0.0;      // path mode: distance travelled over the segment
+        std::size_t lut = NoPath; // path mode: first entry of the arc-length table, or NoPath for a straight line
+    };
+
+    void build()
+    {
+        const std::size_t count = m_track.size();
+        const int dims = m_track.dimensions;
+        m_seconds.resize(count);
+        for (std::size_t key = 0; key < count; ++key)
+        {
+            m_seconds[key] = m_track.seconds(key);
+        }
+        if (count < 2)
+        {
+            return;
+        }
+
+        // Streams with one ease per dimension (scale, anchor point, ...) ease each dimension on its own. Spatial
+        // streams, and streams whose dimensions share one ease, ease the distance travelled instead.
+        m_pathMode = dims > 1 && (m_track.spatial || m_track.temporalDimensions < dims);
+        m_curvesPerSegment = m_pathMode ? 1 : dims;
+        const bool hasTangents =
+            m_track.spatial && m_track.inTangents[0].size() == count && m_track.outTangents[0].size() == count;
+
+        m_segments.resize(count - 1);
+        m_curves.resize((count - 1) * m_curvesPerSegment);
+        for (std::size_t key = 0; key + 1 < count; ++key)
+        {
+            Segment &segment = m_segments[key];
+            const KeyInterp out = m_track.interp.empty() ? KeyInterp::LINEAR : m_track.outInterp(key);
+            const KeyInterp in = m_track.interp.empty() ? KeyInterp::LINEAR : m_track.inInterp(key + 1);
+            if (out == KeyInterp::HOLD)
+            {
+                segment.kind = Kind::Hold;
+                continue;
+            }
+            const bool outBezier = out == KeyInterp::BEZIER;
+            const bool inBezier = in == KeyInterp::BEZIER;
+            segment.kind = (outBezier || inBezier) ? Kind::Bezier : Kind::Linear;
+            const double duration = m_seconds[key + 1] - m_seconds[key];
+
+            Curve *curves = &m_curves[key * m_curvesPerSegment];
+            if (!m_pathMode)
+            {
+                for (int d = 0; d < dims; ++d)
+                {
+                    const double delta = m_track.values[d][key + 1] - m_track.values[d][key];
+                    curves[d] = makeCurve(key, d, delta, duration, outBezier, inBezier);
+                }
+                continue;
+            }
+
+            if (hasTangents && !straight(key))
+            {
+                segment.lut = m_arcLengths.size();
+                segment.length = buildArcLengths(key);
+            }
+            else
+            {
+                double sum = 0.0;
+                for (int d = 0; d < dims; ++d)
+                {
+                    const double delta = m_track.values[d][key + 1] - m_track.values[d][key];
+                    sum += delta * delta;
+                }
+                segment.length = std::sqrt(sum);
+            }
+            curves[0] = makeCurve(key, 0, segment.length, duration, outBezier, inBezier);
+        }
+    }
+
+    Curve makeCurve(std::size_t key, int easeDim, double delta, double duration, bool outBezier, bool inBezier) const
+    {
+        Curve curve;
+        curve.delta = delta;
+        const double averageSpeed = duration > 0.0 ? delta / duration : 0.0;
+        const bool hasEase = easeDim < m_track.temporalDimensions &&
+                             m_track.easeOut[easeDim].size() == m_track.size() &&
+                             m_track.easeIn[easeDim].size() == m_track.size();
+
+        double outSpeed = averageSpeed, outInfluence = 1.0 / 3.0;
+        if (outBezier && hasEase)
+        {
+            outSpeed = m_track.easeOut[easeDim][key].speedF;
+            outInfluence = m_track.easeOut[easeDim][key].influenceF / 100.0;
+        }
+        double inSpeed = averageSpeed, inInfluence = 1.0 / 3.0;
+        if (inBezier && hasEase)
+        {
+            inSpeed = m_track.easeIn[easeDim][key + 1].speedF;
+            inInfluence = m_track.easeIn[easeDim][key + 1].influenceF / 100.0;
+        }
+        outInfluence = std::clamp(outInfluence, 0.0, 1.0);
+        inInfluence = std::clamp(inInfluence, 0.0, 1.0);
+
+        curve.x1 = outInfluence;
+        curve.y1 = outSpeed * duration * outInfluence;
+        curve.x2 = 1.0 - inInfluence;
+        curve.y2 = delta - inSpeed * duration * inInfluence;
+        return curve;
+    }
+
+    bool straight(std::size_t key) const
+    {
+        for (int d = 0; d < m_track.dimensions; ++d)
+        {
+            if (m_track.outTangents[d][key] != 0.0 || m_track.inTangents[d][key + 1] != 0.0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Control points of the spatial path: v0, v0 + outTangent(key), v1 + inTangent(key + 1), v1.
+    void pathPoint(std::size_t key, double u, double *out) const
+    {
+        const double v = 1.0 - u;
+        const double b0 = v * v * v, b1 = 3.0 * v * v * u, b2 = 3.0 * v * u * u, b3 = u * u * u;
+        for (int d = 0; d < m_track.dimensions; ++d)
+        {
+            const double p0 = m_track.values[d][key];
+            const double p3 = m_track.values[d][key + 1];
+            const double p1 = p0 + m_track.outTangents[d][key];
+            const double p2 = p3 + m_track.inTangents[d][key + 1];
+            out[d] = b0 * p0 + b1 * p1 + b2 * p2 + b3 * p3;
+        }
+    }
+
+    // Appends m_pathSamples + 1 cumulative lengths for the segment and returns its total length.
+    double buildArcLengths(std::size_t key)
+    {
+        double previous[MaxDimensions] = {};
+        double point[MaxDimensions] = {};
+        pathPoint(key, 0.0, previous);
+        double length = 0.0;
+        m_arcLengths.push_back(0.0);
+        for (int i = 1; i <= m_pathSamples; ++i)
+        {
+            pathPoint(key, static_cast<double>(i) / m_pathSamples, point);
+            double sum = 0.0;
+            for (int d = 0; d < m_track.dimensions; ++d)
+            {
+                const double delta = point[d] - previous[d];
+                sum += delta * delta;
+                previous[d] = point[d];
+            }
+            length += std::sqrt(sum);
+            m_arcLengths.push_back(length);
+        }
+        return length;
+    }
+
+    // Path parameter at a distance along the segment, interpolated from the arc-length table.
+    double pathParameter(const Segment &segment, double distance) const
+    {
+        const double *table = &m_arcLengths[segment.lut];
+        const double *end = table + m_pathSamples + 1;
+        distance = std::clamp(distance, 0.0, segment.length);
+        const double *upper = std::lower_bound(table + 1, end, distance);
+        if (upper == end)
+        {
+            return 1.0;
+        }
+        const double *lower = upper - 1;
+        const double span = *upper - *lower;
+        const double fraction = span > 0.0 ? (distance - *lower) / span : 0.0;
+        return (static_cast<double>(lower - table) + fraction) / m_pathSamples;
+    }
+
+    void keyValue(std::size_t key, double *out) const
+    {
+        for (int d = 0; d < m_track.dimensions; ++d)
+        {
+            out[d] = m_track.values[d][key];
+        }
+    }
+
+    KeyframeTrack m_track;
+    int m_pathSamples;
+    bool m_pathMode = false;
+    int m_curvesPerSegment = 0;
+    std::vector<double> m_seconds;
+    std::vector<Segment> m_segments;
+    std::vector<Curve> m_curves;      // m_curvesPerSegment entries per segment
+    std::vector<double> m_arcLengths; // m_pathSamples + 1 entries per curved spatial segment
+};
+
+} // namespace ae
+
+#endif // KEYFRAME_EVALUATOR_HPP
@@ -0,0 +1,637 @@
+/*****************************************************************/ /**
+                                                                     * \file   KeyframeTrack.hpp
+                                                                     * \brief  All keyframes of a stream, stored as
+                                                                     *structure-of-arrays.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef KEYFRAME_TRACK_HPP
+#define KEYFRAME_TRACK_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Keyframe.hpp"
+#include "AETK/AEGP/Util/Transaction.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class KeyframeTrack
+ * @brief Every keyframe of one stream, one contiguous array per field.
+ *
+ * Reading keys one KeyFrame at a time costs a main-thread round trip per field per key. KeyframeTrack::read
+ * collects the whole stream in a single hop instead. The layout suits code that walks many keys:
+ * - times are contiguous
+ * - each value dimension is its own array
+ * - interpolation and flags are packed into one byte per key
+ *
+ * Value dimensions: 1D = 1, 2D = 2 (x, y), 3D = 3 (x, y, z), color = 4 (red, green, blue, alpha). Other stream
+ * types (markers, text, masks, ...) only get times, interpolation and flags.
+ *
+ * @example
+ * auto track = layer->Position()->getKeyframeTrack();
+ * for (std::size_t i = 0; i < track.size(); ++i)
+ *     out << track.seconds(i) << " " << track.values[0][i] << " " << track.values[1][i] << "\n";
+ *
+ * Tracks can also be filled directly and written back with BaseProperty::addKeys(track), which inserts every key
+ * in a single AddKeyframes session.
+ */
+class KeyframeTrack
+{
+  public:
+    static constexpr int MaxDimensions = 4;
+
+    StreamType streamType = StreamType::NONE;
+    int dimensions = 0;         // value components per key
+    int temporalDimensions = 0; // ease components per key
+    bool spatial = false;       // whether spatial tangents are stored
+
+    std::vector<A_Time> times;                                         // comp time of each key
+    std::array<std::vector<double>, MaxDimensions> values;             // values[dimension][key]
+    std::vector<std::uint8_t> interp;                                  // in interpolation | out interpolation << 4
+    std::vector<std::uint8_t> flags;                                   // AEGP_KeyframeFlag bits
+    std::array<std::vector<AEGP_KeyframeEase>, MaxDimensions> easeIn;  // easeIn[temporal dimension][key]
+    std::array<std::vector<AEGP_KeyframeEase>, MaxDimensions> easeOut; // easeOut[temporal dimension][key]
+    std::array<std::vector<double>, MaxDimensions> inTangents;         // inTangents[dimension][key], spatial only
+    std::array<std::vector<double>, MaxDimensions> outTangents;        // outTangents[dimension][key], spatial only
+
+    std::size_t size() const { return times.size(); }
+    bool empty() const { return times.empty(); }
+
+    double seconds(std::size_t key) const { return TimeBase::timeToSeconds(times[key]); }
+
+    KeyInterp inInterp(std::size_t key) const { return static_cast<KeyInterp>(interp[key] & 0x0F); }
+    KeyInterp outInterp(std::size_t key) const { return static_cast<KeyInterp>(interp[key] >> 4); }
+
+    bool hasFlag(std::size_t key, KeyframeFlag flag) const { return (flags[key] & static_cast<int>(flag)) != 0; }
+
+    static std::uint8_t packInterp(KeyInterp in, KeyInterp out)
+    {
+        return static_cast<std::uint8_t>((static_cast<int>(in) & 0x0F) | (static_cast<int>(out) << 4));
+    }
+
+    /**
+     * @brief The number of value components stored for a stream type (0 if values are not stored).
+     */
+    static int DimensionsOf(StreamType type)
+    {
+        switch (type)
+        {
+        case StreamType::OneD:
+            return 1;
+        case StreamType::TwoD:
+        case StreamType::TwoD_SPATIAL:
+            return 2;
+        case StreamType::ThreeD:
+        case StreamType::ThreeD_SPATIAL:
+            return 3;
+        case StreamType::COLOR:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    static bool IsSpatial(StreamType type)
+    {
+        return type == StreamType::TwoD_SPATIAL || type == StreamType::ThreeD_SPATIAL;
+    }
+
+    /**
+     * @brief Sets the layout for a stream type and drops any keys.
+     */
+    void reset(StreamType type, int temporalDims)
+    {
+        streamType = type;
+        dimensions = DimensionsOf(type);
+        temporalDimensions = (std::min)(temporalDims, MaxDimensions);
+        spatial = IsSpatial(type);
+        times.clear();
+        interp.clear();
+        flags.clear();
+        for (int d = 0; d < MaxDimensions; ++d)
+        {
+            values[d].clear();
+            easeIn[d].clear();
+            easeOut[d].clear();
+            inTangents[d].clear();
+            outTangents[d].clear();
+        }
+    }
+
+    void reserve(std::size_t count)
+    {
+        times.reserve(count);
+        interp.reserve(count);
+        flags.reserve(count);
+        for (int d = 0; d < dimensions; ++d)
+        {
+            values[d].reserve(count);
+            if (spatial)
+            {
+                inTangents[d].reserve(count);
+                outTangents[d].reserve(count);
+            }
+        }
+        for (int d = 0; d < temporalDimensions; ++d)
+        {
+            easeIn[d].reserve(count);
+            easeOut[d].reserve(count);
+        }
+    }
+
+    /**
+     * @brief Writes the value components of an AEGP stream value to out (dimensions entries).
+     */
+    static void unpackValue(StreamType type, const AEGP_StreamValue2 &value, double *out)
+    {
+        switch (DimensionsOf(type))
+        {
+        case 1:
+            out[0] = value.val.one_d;
+            break;
+        case 2:
+            out[0] = value.val.two_d.x;
+            out[1] = value.val.two_d.y;
+            break;
+        case 3:
+            out[0] = value.val.three_d.x;
+            out[1] = value.val.three_d.y;
+            out[2] = value.val.three_d.z;
+            break;
+        case 4:
+            out[0] = value.val.color.redF;
+            out[1] = value.val.color.greenF;
+            out[2] = value.val.color.blueF;
+            out[3] = value.val.color.alphaF;
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Writes value components (dimensions entries) into an AEGP stream value.
+     */
+    static void packValue(StreamType type, const double *in, AEGP_StreamValue2 &value)
+    {
+        switch (DimensionsOf(type))
+        {
+        case 1:
+            value.val.one_d = in[0];
+            break;
+        case 2:
+            value.val.two_d.x = in[0];
+            value.val.two_d.y = in[1];
+            break;
+        case 3:
+            value.val.three_d.x = in[0];
+            value.val.three_d.y = in[1];
+            value.val.three_d.z = in[2];
+            break;
+        case 4:
+            value.val.color.redF = in[0];
+            value.val.color.greenF = in[1];
+            value.val.color.blueF = in[2];
+            value.val.color.alphaF = in[3];
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Builds the KeyFrame for one key (same contents as BaseProperty::getKeyframe). Columns that do not have
+     * one entry per key (e.g. a hand-filled track without eases) are left at the KeyFrame defaults.
+     */
+    KeyFrame toKeyFrame(std::size_t key) const
+    {
+        KeyFrame keyframe(seconds(key));
+        if (complete(values, dimensions))
+        {
+            keyframe.setValue(tangentValue(values, key));
+        }
+        if (complete(flags))
+        {
+            for (int bit = AEGP_KeyframeFlag_TEMPORAL_CONTINUOUS; bit <= AEGP_KeyframeFlag_ROVING; bit <<= 1)
+            {
+                if (flags[key] & bit)
+                {
+                    keyframe.setFlag(static_cast<KeyframeFlag>(bit));
+                }
+            }
+        }
+        if (complete(interp))
+        {
+            keyframe.setInterpolation(inInterp(key), outInterp(key));
+        }
+        if (temporalDimensions > 0 && complete(easeIn[0]) && complete(easeOut[0]))
+        {
+            keyframe.easeIn = KeyframeEase(easeIn[0][key]);
+            keyframe.easeOut = KeyframeEase(easeOut[0][key]);
+        }
+        if (spatial && complete(inTangents, dimensions) && complete(outTangents, dimensions))
+        {
+            keyframe.tangents = std::make_pair(tangentValue(inTangents, key), tangentValue(outTangents, key));
+        }
+        return keyframe;
+    }
+
+    tk::vector<KeyFrame> toKeyFrames() const
+    {
+        tk::vector<KeyFrame> keyframes;
+        keyframes.reserve(size());
+        for (std::size_t key = 0; key < size(); ++key)
+        {
+            keyframes.push_back(toKeyFrame(key));
+        }
+        return keyframes;
+    }
+
+    /**
+     * @brief Copies the track into packed keyframes; Dim must equal dimensions. Only the Present bits of columns with
+     * one entry per key are set.
+     */
+    template <int Dim> std::vector<PackedKeyframe<Dim>> toPacked() const
+    {
+        if (Dim != dimensions)
+        {
+            throw AEException("Error Packing Keyframe Track. Dimension does not match the stream type");
+        }
+        const bool hasValue = complete(values, Dim);
+        const bool hasEases = temporalDimensions > 0 && complete(easeIn[0]) && complete(easeOut[0]);
+        const bool hasTangents = spatial && complete(inTangents, Dim) && complete(outTangents, Dim);
+        std::vector<PackedKeyframe<Dim>> packed(size());
+        for (std::size_t key = 0; key < size(); ++key)
+        {
+            PackedKeyframe<Dim> &out = packed[key];
+            out.time = seconds(key);
+            if (hasValue)
+            {
+                for (int d = 0; d < Dim; ++d)
+                {
+                    out.value[d] = values[d][key];
+                }
+                out.present |= PackedKeyframe<Dim>::HasValue;
+            }
+            if (complete(flags))
+            {
+                out.flags = flags[key];
+            }
+            if (complete(interp))
+            {
+                out.setInterpolation(inInterp(key), outInterp(key));
+            }
+            if (hasEases)
+            {
+                out.setEaseIn(easeIn[0][key].speedF, easeIn[0][key].influenceF);
+                out.setEaseOut(easeOut[0][key].speedF, easeOut[0][key].influenceF);
+            }
+            if (hasTangents)
+            {
+                for (int d = 0; d < Dim; ++d)
+                {
+                    out.inTangent[d] = inTangents[d][key];
+                    out.outTangent[d] = outTangents[d][key];
+                }
+                out.present |= PackedKeyframe<Dim>::HasTangents;
+            }
+        }
+        return packed;
+    }
+
+    /**
+     * @brief Reads every keyframe of a stream in a single main-thread task.
+     */
+    static KeyframeTrack read(const StreamRefPtr &stream)
+    {
+        CheckNotNull(stream.get(), "Error Reading Keyframe Track. Stream is Null");
+        return ScheduleOrExecute([stream]() {
+                   KeyframeTrack track;
+                   track.readFrom(stream->get());
+                   return track;
+               })
+            .get();
+    }
+
+    /**
+     * @brief Adds every key of the track to a stream in a single main-thread task and undo group.
+     *
+     * All keys are inserted in one AddKeyframes session and committed once. Interpolation, ease, flags and spatial
+     * tangents are then applied in one pass over the committed keys. Only times and values are required: interp and
+     * flags may be left empty, and ease / tangent arrays are applied only when filled for every key. Keys at the same
+     * time as an existing key replace it.
+     *
+     * AE may move a key onto its own time grid, so each key's attributes go to the committed key nearest its time,
+     * within half a frame of base.
+     * @return std::size_t Keys with no committed key that close; their values were added but not their attributes.
+     */
+    std::size_t write(const StreamRefPtr &stream, const TimeBase &base,
+                      const std::string &undoName = "Add Keyframes") const
+    {
+        CheckNotNull(stream.get(), "Error Writing Keyframe Track. Stream is Null");
+        return batch([this, stream, base] { return writeTo(stream->get(), base); }, undoName).get();
+    }
+
+    static bool TimeLess(const A_Time &a, const A_Time &b)
+    {
+        return static_cast<std::int64_t>(a.value) * b.scale < static_cast<std::int64_t>(b.value) * a.scale;
+    }
+
+  private:
+    // Main thread only. Everything that can be checked is checked before the keys are committed.
+    std::size_t writeTo(AEGP_StreamRefH stream, const TimeBase &base) const
+    {
+        const std::size_t count = size();
+        if (count == 0)
+        {
+            return 0;
+        }
+        validate();
+
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *keyframeSuite = suites.KeyframeSuite5();
+        auto *streamSuite = suites.StreamSuite6();
+
+        AEGP_StreamType type = AEGP_StreamType_NO_DATA;
+        AE_CHECK(streamSuite->AEGP_GetStreamType(stream, &type));
+        if (DimensionsOf(static_cast<StreamType>(type)) != dimensions || dimensions == 0)
+        {
+            throw AEException("Error Writing Keyframe Track. Track does not match the stream type");
+        }
+
+        const bool hasInterp = !interp.empty();
+        const bool hasFlags = !flags.empty();
+        A_short streamTemporalDims = 0;
+        AE_CHECK(keyframeSuite->AEGP_GetStreamTemporalDimensionality(stream, &streamTemporalDims));
+        int easeDims = 0;
+        while (easeDims < (std::min)(temporalDimensions, int(streamTemporalDims)) &&
+               easeIn[easeDims].size() == count && easeOut[easeDims].size() == count)
+        {
+            ++easeDims;
+        }
+        const bool hasTangents = spatial && IsSpatial(static_cast<StreamType>(type)) &&
+                                 inTangents[0].size() == count && outTangents[0].size() == count;
+
+        std::vector<std::size_t> order(count);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+                         [this](std::size_t a, std::size_t b) { return TimeLess(times[a], times[b]); });
+
+        AEGP_AddKeyframesInfoH akH = nullptr;
+        AE_CHECK(keyframeSuite->AEGP_StartAddKeyframes(stream, &akH));
+        try
+        {
+            AEGP_StreamValue2 value{};
+            value.streamH = stream;
+            double components[MaxDimensions] = {};
+            for (std::size_t key : order)
+            {
+                A_long keyIndex = 0;
+                AE_CHECK(keyframeSuite->AEGP_AddKeyframes(akH, AEGP_LTimeMode_CompTime, &times[key], &keyIndex));
+                for (int d = 0; d < dimensions; ++d)
+                {
+                    components[d] = values[d][key];
+                }
+                packValue(static_cast<StreamType>(type), components, value);
+                AE_CHECK(keyframeSuite->AEGP_SetAddKeyframe(akH, keyIndex, &value));
+            }
+        }
+        catch (...)
+        {
+            keyframeSuite->AEGP_EndAddKeyframes(FALSE, akH);
+            throw;
+        }
+        AE_CHECK(keyframeSuite->AEGP_EndAddKeyframes(TRUE, akH));
+
+        if (!hasInterp && !hasFlags && easeDims == 0 && !hasTangents)
+        {
+            return 0;
+        }
+
+        // Committed times, in key order.
+        A_long numKeys = 0;
+        AE_CHECK(keyframeSuite->AEGP_GetStreamNumKFs(stream, &numKeys));
+        std::vector<double> committed(static_cast<std::size_t>((std::max)(numKeys, A_long(0))));
+        for (A_long i = 0; i < numKeys; ++i)
+        {
+            A_Time time{0, 1};
+            AE_CHECK(keyframeSuite->AEGP_GetKeyframeTime(stream, i, AEGP_LTimeMode_CompTime, &time));
+            committed[i] = TimeBase::timeToSeconds(time);
+        }
+
+        const double tolerance = 0.5 * TimeBase::timeToSeconds(base.frameDuration());
+        std::size_t unmatched = 0;
+        for (std::size_t key : order)
+        {
+            const AEGP_KeyframeIndex streamKey = nearestKey(committed, seconds(key), tolerance);
+            if (streamKey < 0)
+            {
+                ++unmatched;
+                continue;
+            }
+
+            // Interpolation first: changing it resets the ease.
+            if (hasInterp)
+            {
+                AE_CHECK(keyframeSuite->AEGP_SetKeyframeInterpolation(
+                    stream, streamKey, static_cast<AEGP_KeyframeInterpolationType>(interp[key] & 0x0F),
+                    static_cast<AEGP_KeyframeInterpolationType>(interp[key] >> 4)));
+            }
+            for (int d = 0; d < easeDims; ++d)
+            {
+                AE_CHECK(keyframeSuite->AEGP_SetKeyframeTemporalEase(stream, streamKey, d, &easeIn[d][key],
+                                                                     &easeOut[d][key]));
+            }
+            if (hasTangents)
+            {
+                AEGP_StreamValue2 inTan{}, outTan{};
+                inTan.streamH = outTan.streamH = stream;
+                double inComponents[MaxDimensions] = {};
+                double outComponents[MaxDimensions] = {};
+                for (int d = 0; d < dimensions; ++d)
+                {
+                    inComponents[d] = inTangents[d][key];
+                    outComponents[d] = outTangents[d][key];
+                }
+                packValue(static_cast<StreamType>(type), inComponents, inTan);
+                packValue(static_cast<StreamType>(type), outComponents, outTan);
+                AE_CHECK(keyframeSuite->AEGP_SetKeyframeSpatialTangents(stream, streamKey, &inTan, &outTan));
+            }
+            if (hasFlags && flags[key])
+            {
+                for (int bit = AEGP_KeyframeFlag_TEMPORAL_CONTINUOUS; bit <= AEGP_KeyframeFlag_ROVING; bit <<= 1)
+                {
+                    if (flags[key] & bit)
+                    {
+                        AE_CHECK(keyframeSuite->AEGP_SetKeyframeFlag(stream, streamKey, bit, TRUE));
+                    }
+                }
+            }
+        }
+        return unmatched;
+    }
+
+    // Index of the sorted time nearest to seconds, or -1 if none is within tolerance.
+    static AEGP_KeyframeIndex nearestKey(const std::vector<double> &sorted, double seconds, double tolerance)
+    {
+        const auto upper = std::lower_bound(sorted.begin(), sorted.end(), seconds);
+        auto best = sorted.end();
+        if (upper != sorted.end())
+        {
+            best = upper;
+        }
+        if (upper != sorted.begin() && (best == sorted.end() || seconds - *(upper - 1) < *best - seconds))
+        {
+            best = upper - 1;
+        }
+        if (best == sorted.end() || std::abs(*best - seconds) > tolerance)
+        {
+            return -1;
+        }
+        return static_cast<AEGP_KeyframeIndex>(best - sorted.begin());
+    }
+
+    void validate() const
+    {
+        const std::size_t count = size();
+        for (int d = 0; d < dimensions; ++d)
+        {
+            if (values[d].size() != count)
+            {
+                throw AEException("Error Writing Keyframe Track. Every dimension needs one value per key");
+            }
+            if (spatial && !inTangents[0].empty() &&
+                (inTangents[d].size() != count || outTangents[d].size() != count))
+            {
+                throw AEException("Error Writing Keyframe Track. Tangents need one entry per key and dimension");
+            }
+        }
+        if ((!interp.empty() && interp.size() != count) || (!flags.empty() && flags.size() != count))
+        {
+            throw AEException("Error Writing Keyframe Track. interp and flags must be empty or have one entry per key");
+        }
+    }
+
+    // Main thread only.
+    void readFrom(AEGP_StreamRefH stream)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *keyframeSuite = suites.KeyframeSuite5();
+        auto *streamSuite = suites.StreamSuite6();
+        const AEGP_PluginID pluginID = *SuiteManager::GetInstance().GetPluginID();
+
+        AEGP_StreamType type = AEGP_StreamType_NO_DATA;
+        AE_CHECK(streamSuite->AEGP_GetStreamType(stream, &type));
+        A_long numKeys = 0;
+        AE_CHECK(keyframeSuite->AEGP_GetStreamNumKFs(stream, &numKeys));
+        A_short temporalDims = 0;
+        if (numKeys > 0 && DimensionsOf(static_cast<StreamType>(type)) > 0)
+        {
+            AE_CHECK(keyframeSuite->AEGP_GetStreamTemporalDimensionality(stream, &temporalDims));
+        }
+
+        reset(static_cast<StreamType>(type), temporalDims);
+        reserve(static_cast<std::size_t>((std::max)(numKeys, A_long(0))));
+
+        for (AEGP_KeyframeIndex key = 0; key < numKeys; ++key)
+        {
+            A_Time time{0, 1};
+            AE_CHECK(keyframeSuite->AEGP_GetKeyframeTime(stream, key, AEGP_LTimeMode_CompTime, &time));
+            times.push_back(time);
+
+            AEGP_KeyframeFlags keyFlags = AEGP_KeyframeFlag_NONE;
+            AE_CHECK(keyframeSuite->AEGP_GetKeyframeFlags(stream, key, &keyFlags));
+            flags.push_back(static_cast<std::uint8_t>(keyFlags));
+
+            AEGP_KeyframeInterpolationType in = AEGP_KeyInterp_NONE, out = AEGP_KeyInterp_NONE;
+            AE_CHECK(keyframeSuite->AEGP_GetKeyframeInterpolation(stream, key, &in, &out));
+            interp.push_back(packInterp(static_cast<KeyInterp>(in), static_cast<KeyInterp>(out)));
+
+            if (dimensions == 0)
+            {
+                continue;
+            }
+
+            double components[MaxDimensions] = {};
+            AEGP_StreamValue2 value;
+            AE_CHECK(keyframeSuite->AEGP_GetNewKeyframeValue(pluginID, stream, key, &value));
+            unpackValue(streamType, value, components);
+            AE_CHECK(streamSuite->AEGP_DisposeStreamValue(&value));
+            for (int d = 0; d < dimensions; ++d)
+            {
+                values[d].push_back(components[d]);
+            }
+
+            for (int d = 0; d < temporalDimensions; ++d)
+            {
+                AEGP_KeyframeEase inEase, outEase;
+                AE_CHECK(keyframeSuite->AEGP_GetKeyframeTemporalEase(stream, key, d, &inEase, &outEase));
+                easeIn[d].push_back(inEase);
+                easeOut[d].push_back(outEase);
+            }
+
+            if (spatial)
+            {
+                AEGP_StreamValue2 inTan, outTan;
+                AE_CHECK(keyframeSuite->AEGP_GetNewKeyframeSpatialTangents(pluginID, stream, key, &inTan, &outTan));
+                double inComponents[MaxDimensions] = {};
+                double outComponents[MaxDimensions] = {};
+                unpackValue(streamType, inTan, inComponents);
+                unpackValue(streamType, outTan, outComponents);
+                AE_CHECK(streamSuite->AEGP_DisposeStreamValue(&inTan));
+                AE_CHECK(streamSuite->AEGP_DisposeStreamValue(&outTan));
+                for (int d = 0; d < dimensions; ++d)
+                {
+                    inTangents[d].push_back(inComponents[d]);
+                    outTangents[d].push_back(outComponents[d]);
+                }
+            }
+        }
+    }
+
+    // Whether a per-key column holds an entry for every key.
+    template <typename T> bool complete(const std::vector<T> &column) const { return column.size() == size(); }
+
+    template <typename T> bool complete(const std::array<std::vector<T>, MaxDimensions> &columns, int count) const
+    {
+        for (int d = 0; d < count; ++d)
+        {
+            if (!complete(columns[d]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    KeyFrame::TangentValue tangentValue(const std::array<std::vector<double>, MaxDimensions> &source,
+                                        std::size_t key) const
+    {
+        switch (dimensions)
+        {
+        case 1:
+            return source[0][key];
+        case 2:
+            return TwoDVal(source[0][key], source[1][key]);
+        case 3:
+            return ThreeDVal(source[0][key], source[1][key], source[2][key]);
+        case 4:
+            return ColorVal(source[0][key], source[1][key], source[2][key], source[3][key]);
+        default:
+            return std::monostate();
+        }
+    }
+};
+
+} // namespace ae
+
+#endif // KEYFRAME_TRACK_HPP
@@ -52,6 +52,9 @@ class Mask : public PropertyGroup
     tk::shared_ptr<TwoDProperty> feather();
     tk::shared_ptr<OneDProperty> expansion();
 
+  protected:
+    StreamRefPtr acquireStream() const override { return DynamicStreamSuite().GetNewStreamRefForMask(m_mask); }
+
   private:
     MaskRefPtr m_mask;
 };
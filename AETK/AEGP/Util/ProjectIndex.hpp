@@ -0,0 +1,170 @@
+/*****************************************************************/ /**
+                                                                     * \file   ProjectIndex.hpp
+                                                                     * \brief  One-pass index of every item in a
+                                                                     *project.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+
+#ifndef PROJECT_INDEX_HPP
+#define PROJECT_INDEX_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Transaction.hpp"
+
+#include <unordered_map>
+
+namespace ae
+{
+
+/**
+ * @class ProjectIndex
+ * @brief Snapshot of a project's item tree, built with a single walk.
+ *
+ * Building the tree by asking every item for its parent once per folder is quadratic in the project size. The index
+ * walks the project once (GetFirstProjItem / GetNextProjItem), records each item's id, name, type and parent folder,
+ * and builds parent -> children adjacency plus lookup tables by id, name and type. The whole walk runs as one
+ * main-thread task.
+ *
+ * The index is a snapshot: build a new one after items are added, removed or moved.
+ *
+ * @example
+ * auto index = ae::ProjectIndex::build();
+ * for (auto i : index->children(index->root()))
+ *     std::cout << index->entry(i).name << "\n";
+ */
+class ProjectIndex
+{
+  public:
+    struct Entry
+    {
+        AEGP_ItemH handle = nullptr;
+        AEGP_ItemH parent = nullptr;
+        A_long id = 0;
+        ItemType type = ItemType::NONE;
+        std::string name;
+    };
+
+    /**
+     * @brief Walks the project once and builds the index.
+     * @param projectIndex The project to index (After Effects only has project 0).
+     */
+    static std::shared_ptr<ProjectIndex> build(int projectIndex = 0)
+    {
+        return batch([projectIndex] {
+                   auto index = std::make_shared<ProjectIndex>();
+                   index->walk(projectIndex);
+                   return index;
+               })
+            .get();
+    }
+
+    /**
+     * @brief The project's root folder.
+     */
+    AEGP_ItemH root() const { return m_root; }
+
+    std::size_t size() const { return m_entries.size(); }
+
+    const Entry &entry(std::size_t index) const { return m_entries[index]; }
+
+    const std::vector<Entry> &entries() const { return m_entries; }
+
+    /**
+     * @brief Indexes of the items directly inside a folder, in project order.
+     */
+    const std::vector<std::size_t> &children(AEGP_ItemH folder) const { return lookup(m_children, folder); }
+
+    /**
+     * @brief The entry with the given item id, or nullptr.
+     */
+    const Entry *findById(A_long id) const
+    {
+        auto it = m_byId.find(id);
+        return it == m_byId.end() ? nullptr : &m_entries[it->second];
+    }
+
+    /**
+     * @brief The entry for an item handle, or nullptr.
+     */
+    const Entry *find(AEGP_ItemH item) const
+    {
+        auto it = m_byHandle.find(item);
+        return it == m_byHandle.end() ? nullptr : &m_entries[it->second];
+    }
+
+    /**
+     * @brief Indexes of all items with the given name (names are not unique).
+     */
+    const std::vector<std::size_t> &findByName(const std::string &name) const { return lookup(m_byName, name); }
+
+    /**
+     * @brief Indexes of all items of the given type.
+     */
+    const std::vector<std::size_t> &ofType(ItemType type) const { return lookup(m_byType, static_cast<int>(type)); }
+
+    /**
+     * @brief Wraps an entry's handle for the suite wrappers and item classes.
+     */
+    static ItemPtr itemPtr(const Entry &entry) { return makeItemPtr(entry.handle); }
+
+  private:
+    void walk(int projectIndex)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *itemSuite = suites.ItemSuite9();
+        const AEGP_PluginID pluginID = *SuiteManager::GetInstance().GetPluginID();
+
+        AEGP_ProjectH project = nullptr;
+        AE_CHECK(suites.ProjSuite6()->AEGP_GetProjectByIndex(projectIndex, &project));
+        AE_CHECK(suites.ProjSuite6()->AEGP_GetProjectRootFolder(project, &m_root));
+
+        AEGP_ItemH item = nullptr;
+        AE_CHECK(itemSuite->AEGP_GetFirstProjItem(project, &item));
+        while (item)
+        {
+            Entry entry;
+            entry.handle = item;
+            AEGP_ItemType type = AEGP_ItemType_NONE;
+            AE_CHECK(itemSuite->AEGP_GetItemType(item, &type));
+            entry.type = static_cast<ItemType>(type);
+            AE_CHECK(itemSuite->AEGP_GetItemID(item, &entry.id));
+            AE_CHECK(itemSuite->AEGP_GetItemParentFolder(item, &entry.parent));
+            AEGP_MemHandle nameH = nullptr;
+            AE_CHECK(itemSuite->AEGP_GetItemName(pluginID, item, &nameH));
+            entry.name = memHandleToString(nameH);
+
+            const std::size_t index = m_entries.size();
+            m_children[entry.parent].push_back(index);
+            m_byHandle.emplace(item, index);
+            m_byId.emplace(entry.id, index);
+            m_byName[entry.name].push_back(index);
+            m_byType[static_cast<int>(entry.type)].push_back(index);
+            m_entries.push_back(std::move(entry));
+
+            AEGP_ItemH next = nullptr;
+            AE_CHECK(itemSuite->AEGP_GetNextProjItem(project, item, &next));
+            item = next;
+        }
+    }
+
+    template <typename Map, typename Key> static const std::vector<std::size_t> &lookup(const Map &map, const Key &key)
+    {
+        static const std::vector<std::size_t> none;
+        auto it = map.find(key);
+        return it == map.end() ? none : it->second;
+    }
+
+    AEGP_ItemH m_root = nullptr;
+    std::vector<Entry> m_entries;
+    std::unordered_map<AEGP_ItemH, std::vector<std::size_t>> m_children;
+    std::unordered_map<AEGP_ItemH, std::size_t> m_byHandle;
+    std::unordered_map<A_long, std::size_t> m_byId;
+    std::unordered_map<std::string, std::vector<std::size_t>> m_byName;
+    std::unordered_map<int, std::vector<std::size_t>> m_byType;
+};
+
+} // namespace ae
+
+#endif // PROJECT_INDEX_HPP
@@ -16,8 +16,15 @@
 
 
 #include <AETK/AEGP/Util/Keyframe.hpp>
+#include <AETK/AEGP/Util/KeyframeTrack.hpp>
+#include <AETK/AEGP/Util/PropertySamples.hpp>
+#include <atomic>
 #include <cmath>  // For std::abs
+#include <cstdint>
 #include <limits> // Include this at the top of your file
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 class BaseProperty
 {
@@ -30,7 +37,23 @@ class BaseProperty
 
     std::string getName() const;
     void setName(const std::string &name);
-    StreamRefPtr getStream() const { return m_property; }
+    /**
+     * @brief Gets the property's stream, acquiring it on first use for properties created without one.
+     */
+    StreamRefPtr getStream() const
+    {
+        StreamRefPtr current = std::atomic_load(&m_property);
+        if (current)
+        {
+            return current;
+        }
+        StreamRefPtr acquired = acquireStream();
+        if (acquired && !std::atomic_compare_exchange_strong(&m_property, &current, acquired))
+        {
+            return current; // another thread got there first; ours is disposed here
+        }
+        return acquired;
+    }
    std::shared_ptr<BaseProperty> duplicate();
     std::string matchName() const;
 
@@ -61,13 +84,107 @@ class BaseProperty
 
     inline tk::vector<KeyFrame> getKeyframes();
 
+    /**
+     * @brief Reads every keyframe of the stream in one main-thread task.
+     *
+     * Prefer this over numKeys() + getKeyframe(i) when walking many keys; those cost several hops per key.
+     */
+    ae::KeyframeTrack getKeyframeTrack() { return ae::KeyframeTrack::read(getStream()); }
+
+    /**
+     * @brief Samples several 1D / 2D / 3D / color properties over the same range in one main-thread task.
+     *
+     * See OneDProperty::sample. Results are in the same order as properties.
+     */
+    static std::vector<ae::PropertySamples> sample(const std::vector<std::shared_ptr<BaseProperty>> &properties,
+                                                   double t0, double t1, double step, bool preExpression = false)
+    {
+        std::vector<std::pair<StreamRefPtr, ae::TimeBase>> streams;
+        streams.reserve(properties.size());
+        for (const auto &property : properties)
+        {
+            CheckNotNull(property.get(), "Error Sampling Properties. Property is Null");
+            streams.emplace_back(property->getStream(), property->timeBase());
+        }
+        return ae::PropertySamples::read(streams, t0, t1, step, preExpression);
+    }
+
     inline KeyFrame getNearestKeyframe(double time);
 
     inline void addKey(const KeyFrame &keyframe);
 
     inline void addKeys(const tk::vector<KeyFrame> &keyframes);
 
+    // Keyframe times are converted with the given time base instead of looking one up.
+    inline void addKey(const KeyFrame &keyframe, const ae::TimeBase &base);
+
+    inline void addKeys(const tk::vector<KeyFrame> &keyframes, const ae::TimeBase &base);
+
+    /**
+     * @brief Adds every key of a track in one AddKeyframes session, one undo group and one main-thread task.
+     *
+     * Much faster than addKeys(tk::vector<KeyFrame>) for large bakes. See ae::KeyframeTrack::write, including
+     * its return value.
+     */
+    std::size_t addKeys(const ae::KeyframeTrack &track, const std::string &undoName = "Add Keyframes")
+    {
+        return track.write(getStream(), timeBase(), undoName);
+    }
+
+    /**
+     * @brief The time base used to convert this property's times.
+     *
+     * Properties resolved from a layer share the layer's comp time base, fetched once on first use. Properties with
+     * no known layer fall back to the most recently used comp.
+     */
+    ae::TimeBase timeBase() const { return timeBaseSource()->get(); }
+
+    void setTimeBase(const ae::TimeBase &base)
+    {
+        std::atomic_store(&m_timeBase, std::make_shared<ae::LazyTimeBase>(base));
+    }
+
+    /**
+     * @brief Shares parent's time base (resolved or not) with this property.
+     */
+    void inheritTimeBase(const BaseProperty &parent) { std::atomic_store(&m_timeBase, parent.timeBaseSource()); }
+
   protected:
+    ae::PropertySamples sampleRange(double t0, double t1, double step, bool preExpression) const
+    {
+        return ae::PropertySamples::read(getStream(), timeBase(), t0, t1, step, preExpression);
+    }
+
+    /**
+     * @brief Called by getStream() when the property was constructed without a stream.
+     * Override to defer acquiring the root stream (layers, masks) until a property method needs it.
+     */
+    virtual StreamRefPtr acquireStream() const { return nullptr; }
+
+    /**
+     * @brief Drops the current stream so the next getStream() acquires it again.
+     */
+    void resetStream() { std::atomic_store(&m_property, StreamRefPtr()); }
+
+    void setTimeBaseSource(std::shared_ptr<ae::LazyTimeBase> source)
+    {
+        std::atomic_store(&m_timeBase, std::move(source));
+    }
+
+    std::shared_ptr<ae::LazyTimeBase> timeBaseSource() const
+    {
+        auto current = std::atomic_load(&m_timeBase);
+        if (!current)
+        {
+            auto fallback = std::make_shared<ae::LazyTimeBase>([] { return ae::TimeBase::mostRecent(); });
+            if (std::atomic_compare_exchange_strong(&m_timeBase, &current, fallback))
+            {
+                current = std::move(fallback);
+            }
+        }
+        return current;
+    }
+
     inline void setKeyFlags(AEGP_KeyframeIndex keyIndex, tk::vector<KeyframeFlag> flags);
 
     inline void setKeyInterpolation(AEGP_KeyframeIndex keyIndex, KeyInterp inInterp, KeyInterp outInterp);
@@ -81,7 +198,102 @@ class BaseProperty
 
     KeyFrame::TangentValue convertToTangentValue(AEGP_StreamValue2 value);
 
-    StreamRefPtr m_property;
+  private:
+    mutable StreamRefPtr m_property; // read through getStream()
+    mutable std::shared_ptr<ae::LazyTimeBase> m_timeBase; // read through timeBaseSource()
+};
+
+/**
+ * @class PropertyCache
+ * @brief Remembers the child properties a PropertyGroup has already resolved.
+ *
+ * Resolving a child costs three suite calls (the stream ref, its grouping type and its stream type). The cache keeps
+ * the resulting property, keyed by match name or by LayerStream, so repeated lookups such as `layer->Position()` in
+ * a loop cost one hash lookup. Lookups by index are not cached, since a reorder in the UI moves every index after it.
+ *
+ * Entries are dropped when the group changes its own children (add/remove/duplicate/reorder), or when the global
+ * generation is bumped with invalidateAll(). With change tracking enabled, ChangeTracker::poll() bumps it whenever
+ * the project's render timestamp moves, which covers effects deleted or added in the UI. Without it, bump the
+ * generation after changing streams outside of AETK, such as from a script or through raw suite calls.
+ */
+class PropertyCache
+{
+  public:
+    PropertyCache() = default;
+    // A copied group resolves its own children again; entries are never shared between groups.
+    PropertyCache(const PropertyCache &) {}
+    PropertyCache &operator=(const PropertyCache &)
+    {
+        clear();
+        return *this;
+    }
+
+    template <typename Resolve> std::shared_ptr<BaseProperty> byName(const std::string &name, Resolve &&resolve)
+    {
+        return lookup(m_byName, name, std::forward<Resolve>(resolve));
+    }
+
+    template <typename Resolve> std::shared_ptr<BaseProperty> byLayerStream(LayerStream stream, Resolve &&resolve)
+    {
+        return lookup(m_byLayerStream, static_cast<int>(stream), std::forward<Resolve>(resolve));
+    }
+
+    /**
+     * @brief Drops every entry of this cache.
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_byName.clear();
+        m_byLayerStream.clear();
+    }
+
+    /**
+     * @brief Drops the entries of every PropertyCache the next time it is used.
+     */
+    static void invalidateAll() { s_generation.fetch_add(1, std::memory_order_acq_rel); }
+
+    static std::uint64_t generation() { return s_generation.load(std::memory_order_acquire); }
+
+  private:
+    // Resolve runs without the lock held: it may wait on the main thread, which may itself be using this cache.
+    template <typename Map, typename Key, typename Resolve>
+    std::shared_ptr<BaseProperty> lookup(Map &map, const Key &key, Resolve &&resolve)
+    {
+        std::uint64_t current = generation();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_generation != current)
+            {
+                m_byName.clear();
+                m_byLayerStream.clear();
+                m_generation = current;
+            }
+            auto it = map.find(key);
+            if (it != map.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::shared_ptr<BaseProperty> property = resolve();
+        if (property)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_generation == current && generation() == current)
+            {
+                property = map.emplace(key, std::move(property)).first->second;
+            }
+        }
+        return property;
+    }
+
+    inline static std::atomic<std::uint64_t> s_generation{0};
+
+    std::mutex m_mutex;
+    std::uint64_t m_generation = 0;
+    std::unordered_map<std::string, std::shared_ptr<BaseProperty>> m_byName;
+    std::unordered_map<int, std::shared_ptr<BaseProperty>> m_byLayerStream;
 };
 
 class PropertyGroup : public BaseProperty
@@ -105,6 +317,14 @@ class PropertyGroup : public BaseProperty
     void removeProperty(const std::string &name) const override;
 
     void removeProperty(int index) const override;
+
+    /**
+     * @brief Forgets the children resolved so far by this group.
+     */
+    void invalidateCache() const { m_cache.clear(); }
+
+  protected:
+    mutable PropertyCache m_cache;
 };
 
 class OneDProperty : public BaseProperty
@@ -119,6 +339,16 @@ class OneDProperty : public BaseProperty
     double getValue(LTimeMode timeMode = LTimeMode::CompTime, double time = 0.0,
                     bool preExpression = TRUE) const; // returns the value of the property at the given time
     void setValue(double value);                      // sets the value of the property
+
+    /**
+     * @brief Values from t0 to t1 (seconds, inclusive) every step seconds, read in one main-thread task.
+     * @param preExpression Whether to read values before expressions; defaults to the post-expression value.
+     */
+    ae::PropertySamples sample(double t0, double t1, double step, bool preExpression = false) const
+    {
+        return sampleRange(t0, t1, step, preExpression);
+    }
+    using BaseProperty::sample;
 };
 
 class TwoDProperty : public BaseProperty
@@ -133,6 +363,12 @@ class TwoDProperty : public BaseProperty
     TwoDVal getValue(LTimeMode timeMode = LTimeMode::CompTime, double time = 0.0,
                      bool preExpression = TRUE) const; // returns the value of the property at the given time
     void setValue(TwoDVal value);                      // sets the value of the property
+
+    ae::PropertySamples sample(double t0, double t1, double step, bool preExpression = false) const
+    {
+        return sampleRange(t0, t1, step, preExpression);
+    }
+    using BaseProperty::sample;
 };
 
 class ThreeDProperty : public BaseProperty
@@ -146,6 +382,12 @@ class ThreeDProperty : public BaseProperty
 
     ThreeDVal getValue(LTimeMode timeMode = LTimeMode::CompTime, double time = 0.0, bool preExpression = TRUE) const;
     void setValue(ThreeDVal value);
+
+    ae::PropertySamples sample(double t0, double t1, double step, bool preExpression = false) const
+    {
+        return sampleRange(t0, t1, step, preExpression);
+    }
+    using BaseProperty::sample;
 };
 
 class ColorProperty : public BaseProperty
@@ -159,6 +401,12 @@ class ColorProperty : public BaseProperty
 
     ColorVal getValue(LTimeMode timeMode = LTimeMode::CompTime, double time = 0.0, bool preExpression = TRUE) const;
     void setValue(ColorVal value);
+
+    ae::PropertySamples sample(double t0, double t1, double step, bool preExpression = false) const
+    {
+        return sampleRange(t0, t1, step, preExpression);
+    }
+    using BaseProperty::sample;
 };
 
 class MarkerProperty : public BaseProperty
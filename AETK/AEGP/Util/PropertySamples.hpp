@@ -0,0 +1,177 @@
+/*****************************************************************/ /**
+                                                                     * \file   PropertySamples.hpp
+                                                                     * \brief  Property values over a time range, read
+                                                                     *in one main-thread task.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef PROPERTY_SAMPLES_HPP
+#define PROPERTY_SAMPLES_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/KeyframeTrack.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class PropertySamples
+ * @brief Values of one stream at evenly spaced times, one contiguous array per dimension.
+ *
+ * Calling getValue() in a loop schedules every sample separately. PropertySamples::read asks AE for the whole range
+ * in one main-thread task, which gets and disposes one stream value per sample. By default values are
+ * post-expression, so the result can be used to bake an expression.
+ *
+ * @example
+ * auto samples = layer->Position()->sample(0.0, 10.0, 1.0 / 30.0);
+ * for (std::size_t i = 0; i < samples.size(); ++i)
+ *     out << samples.times[i] << " " << samples.values[0][i] << " " << samples.values[1][i] << "\n";
+ */
+class PropertySamples
+{
+  public:
+    static constexpr int MaxDimensions = KeyframeTrack::MaxDimensions;
+
+    StreamType streamType = StreamType::NONE;
+    int dimensions = 0;
+    std::vector<double> times;                            // comp time of each sample, in seconds
+    std::array<std::vector<double>, MaxDimensions> values; // values[dimension][sample]
+
+    std::size_t size() const { return times.size(); }
+    bool empty() const { return times.empty(); }
+
+    /**
+     * @brief Number of samples from t0 to t1 (inclusive) every step seconds.
+     */
+    static std::size_t Count(double t0, double t1, double step)
+    {
+        if (!(step > 0.0))
+        {
+            throw AEException("Error Sampling Property. Step must be greater than zero");
+        }
+        if (t1 < t0)
+        {
+            return 0;
+        }
+        return static_cast<std::size_t>(std::floor((t1 - t0) / step + 1e-9)) + 1;
+    }
+
+    /**
+     * @brief Samples one stream in a single main-thread task.
+     * @param base Time base used to convert sample times (the property's comp).
+     * @param preExpression Whether to read values before expressions are applied.
+     */
+    static PropertySamples read(const StreamRefPtr &stream, const TimeBase &base, double t0, double t1, double step,
+                                bool preExpression = false)
+    {
+        CheckNotNull(stream.get(), "Error Sampling Property. Stream is Null");
+        const std::size_t count = Count(t0, t1, step);
+        return ScheduleOrExecute([stream, base, t0, step, count, preExpression]() {
+                   PropertySamples samples;
+                   samples.readFrom(stream->get(), base, t0, step, count, preExpression);
+                   return samples;
+               })
+            .get();
+    }
+
+    /**
+     * @brief Samples several streams over the same range in a single main-thread task.
+     * @param streams Streams paired with the time base of their comp.
+     */
+    static std::vector<PropertySamples> read(const std::vector<std::pair<StreamRefPtr, TimeBase>> &streams, double t0,
+                                             double t1, double step, bool preExpression = false)
+    {
+        for (const auto &stream : streams)
+        {
+            CheckNotNull(stream.first.get(), "Error Sampling Property. Stream is Null");
+        }
+        const std::size_t count = Count(t0, t1, step);
+        return ScheduleOrExecute([streams, t0, step, count, preExpression]() {
+                   std::vector<PropertySamples> result(streams.size());
+                   for (std::size_t i = 0; i < streams.size(); ++i)
+                   {
+                       result[i].readFrom(streams[i].first->get(), streams[i].second, t0, step, count,
+                                          preExpression);
+                   }
+                   return result;
+               })
+            .get();
+    }
+
+    /**
+     * @brief The A_Time for a sample: exact on frame boundaries, otherwise with a 16 times finer time scale.
+     *
+     * Value and scale are computed in 64 bits. When the finer scale does not fit an A_Time (large time scales or
+     * late times), it is halved until it does, down to the comp's own scale.
+     */
+    static A_Time ToTime(double seconds, const TimeBase &base)
+    {
+        const A_Time frame = base.frameDuration();
+        const double frames = seconds * base.frameRate();
+        const double nearest = std::round(frames);
+        const bool onFrame = std::abs(frames - nearest) < 1e-6;
+        for (long long subdivision = onFrame ? 1 : 16; subdivision >= 1; subdivision /= 2)
+        {
+            const long long scale = static_cast<long long>(frame.scale) * subdivision;
+            const double units = onFrame ? nearest * frame.value : std::round(frames * subdivision * frame.value);
+            if (scale <= static_cast<long long>((std::numeric_limits<A_u_long>::max)()) &&
+                std::abs(units) <= static_cast<double>((std::numeric_limits<A_long>::max)()))
+            {
+                return A_Time{static_cast<A_long>(units), static_cast<A_u_long>(scale)};
+            }
+        }
+        throw AEException("Error Sampling Property. Time is outside the range of an A_Time");
+    }
+
+  private:
+    // Main thread only.
+    void readFrom(AEGP_StreamRefH stream, const TimeBase &base, double t0, double step, std::size_t count,
+                  bool preExpression)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *streamSuite = suites.StreamSuite6();
+        const AEGP_PluginID pluginID = *SuiteManager::GetInstance().GetPluginID();
+
+        AEGP_StreamType type = AEGP_StreamType_NO_DATA;
+        AE_CHECK(streamSuite->AEGP_GetStreamType(stream, &type));
+        streamType = static_cast<StreamType>(type);
+        dimensions = KeyframeTrack::DimensionsOf(streamType);
+        if (dimensions == 0)
+        {
+            throw AEException("Error Sampling Property. Only 1D, 2D, 3D and color properties can be sampled");
+        }
+
+        times.resize(count);
+        for (int d = 0; d < dimensions; ++d)
+        {
+            values[d].resize(count);
+        }
+
+        AEGP_StreamValue2 value;
+        double components[MaxDimensions] = {};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const double seconds = t0 + static_cast<double>(i) * step;
+            const A_Time time = ToTime(seconds, base);
+            AE_CHECK(streamSuite->AEGP_GetNewStreamValue(pluginID, stream, AEGP_LTimeMode_CompTime, &time,
+                                                         preExpression, &value));
+            KeyframeTrack::unpackValue(streamType, value, components);
+            AE_CHECK(streamSuite->AEGP_DisposeStreamValue(&value));
+            times[i] = seconds;
+            for (int d = 0; d < dimensions; ++d)
+            {
+                values[d][i] = components[d];
+            }
+        }
+    }
+};
+
+} // namespace ae
+
+#endif // PROPERTY_SAMPLES_HPP
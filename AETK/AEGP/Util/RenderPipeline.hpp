@@ -0,0 +1,613 @@
+/*****************************************************************/ /**
+                                                                     * \file   RenderPipeline.hpp
+                                                                     * \brief  Bounded asynchronous rendering of layer
+                                                                     *frame ranges.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef RENDER_PIPELINE_HPP
+#define RENDER_PIPELINE_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/ImageView.hpp"
+#include "AETK/AEGP/Util/WorkerPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @brief A rendered frame as handed to a RenderPipeline handler.
+ *
+ * The pixels are a copy owned by the pipeline and stay valid until the handler returns; the buffer is then reused
+ * for a later frame. Pixels are ARGB, bitDepth bits per channel (8 and 16 bit integer, 32 bit float), rows packed
+ * without padding.
+ */
+struct RenderedFrame
+{
+    A_long frame = 0;        // frame number in the pipeline's time base
+    A_Time time{0, 1};       // comp time that was rendered
+    A_long width = 0;
+    A_long height = 0;
+    A_u_long rowBytes = 0;
+    int bitDepth = 8;
+    const void *data = nullptr;
+    double renderMs = 0.0;   // request to callback
+
+    // Calls func with a typed ImageView of the pixels; see visit_world.
+    template <typename Func> decltype(auto) visit(Func &&func) const
+    {
+        return visit_pixels(const_cast<void *>(data), bitDepth, width, height, static_cast<std::ptrdiff_t>(rowBytes),
+                            std::forward<Func>(func));
+    }
+};
+
+/**
+ * @brief Counters and latency figures for a RenderPipeline run.
+ */
+struct RenderStats
+{
+    std::size_t submitted = 0;
+    std::size_t completed = 0; // rendered and handled
+    std::size_t failed = 0;    // render errors and handler exceptions
+    std::size_t canceled = 0;
+    std::size_t peakInFlight = 0;
+    double renderMsMin = 0.0, renderMsMean = 0.0, renderMsP95 = 0.0, renderMsMax = 0.0;     // request to callback
+    double processMsMin = 0.0, processMsMean = 0.0, processMsP95 = 0.0, processMsMax = 0.0; // handler run time
+    double elapsedMs = 0.0;
+};
+
+/**
+ * @brief Limits and worker pool of a RenderPipeline.
+ */
+struct RenderPipelineOptions
+{
+    std::size_t maxInFlight = 4; // render requests queued in AE at once
+    std::size_t maxPending = 8;  // finished frames waiting for, or inside, a handler
+    WorkerPool *pool = nullptr;  // defaults to WorkerPool::GetInstance()
+};
+
+/**
+ * @class RenderPipeline
+ * @brief Renders a range of layer frames with a bounded number of asynchronous requests in flight.
+ *
+ * Requests are issued with AEGP_RenderAndCheckoutLayerFrame_Async from the main thread, at most maxInFlight at a
+ * time, so AE's renderer always has work queued. AE owns the frame receipt only for the duration of its callback, so
+ * the callback copies the pixels into a pooled buffer and hands that to a WorkerPool thread for post-processing
+ * (encoding, writing). When maxPending frames are waiting for or inside handlers, no new requests are issued until
+ * they drain (backpressure), which bounds the number of buffers to maxPending + maxInFlight.
+ *
+ * Everything is driven from the TaskScheduler, so the plugin's idle hook must be registered. start() may be called
+ * from any thread; the returned future must not be waited on from the main thread.
+ *
+ * @example
+ * auto options = LayerRenderOptionsSuite().newFromLayer(layer->getLayer());
+ * auto pipeline = ae::RenderPipeline::create(options, [](const ae::RenderedFrame &frame) { encode(frame); });
+ * std::thread([pipeline, base] {
+ *     ae::RenderStats stats = pipeline->start(0, 999, base).get();
+ * }).detach();
+ */
+class RenderPipeline : public std::enable_shared_from_this<RenderPipeline>
+{
+  public:
+    using FrameHandler = std::function<void(const RenderedFrame &)>;
+    using FailureHandler = std::function<void(A_long frame, bool canceled)>;
+
+    using Options = RenderPipelineOptions;
+
+    /**
+     * @param options Render options to copy for each frame (time is set per frame).
+     * @param handler Runs on a worker thread for each rendered frame, in completion order.
+     */
+    static std::shared_ptr<RenderPipeline> create(LayerRenderOptionsPtr options, FrameHandler handler,
+                                                  Options settings = Options())
+    {
+        return std::shared_ptr<RenderPipeline>(new RenderPipeline(std::move(options), std::move(handler), settings));
+    }
+
+    RenderPipeline(const RenderPipeline &) = delete;
+    RenderPipeline &operator=(const RenderPipeline &) = delete;
+
+    /**
+     * @brief Called for each frame that will not reach the frame handler (render error, cancellation, or a handler
+     * exception), on the main thread or a worker thread. Set it before start().
+     */
+    void onFailure(FailureHandler handler)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_started)
+        {
+            throw AEException("Error Setting Failure Handler. Pipeline was already started");
+        }
+        m_onFailure = std::move(handler);
+    }
+
+    /**
+     * @brief Renders frames first..last (inclusive) of the given time base.
+     * @return std::future<RenderStats> Ready once every frame was handled or canceled.
+     */
+    std::future<RenderStats> start(A_long first, A_long last, const TimeBase &base)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_started)
+        {
+            throw AEException("Error Starting Render Pipeline. Pipeline was already started");
+        }
+        m_started = true;
+        m_next = first;
+        m_last = last;
+        m_base = base;
+        m_startTime = Clock::now();
+        auto future = m_done.get_future();
+        schedulePump();
+        return future;
+    }
+
+    /**
+     * @brief Stops issuing requests and cancels the ones in flight. Frames already rendered are still handled.
+     */
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_canceled = true;
+        }
+        auto self = shared_from_this();
+        TaskScheduler::GetInstance().ScheduleTask([self] { self->cancelInFlight(); });
+    }
+
+    /**
+     * @brief Statistics so far.
+     */
+    RenderStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return buildStats();
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using Buffer = std::vector<std::uint8_t>;
+
+    struct Request
+    {
+        std::weak_ptr<RenderPipeline> pipeline;
+        A_long frame = 0;
+        A_Time time{0, 1};
+        AEGP_LayerRenderOptionsH options = nullptr;
+        AEGP_AsyncRequestId id = 0;
+        Clock::time_point issued;
+    };
+
+    RenderPipeline(LayerRenderOptionsPtr options, FrameHandler handler, Options settings)
+        : m_options(std::move(options)), m_handler(std::move(handler)), m_settings(settings)
+    {
+        CheckNotNull(m_options.get(), "Error Creating Render Pipeline. Options are Null");
+        m_settings.maxInFlight = (std::max)(m_settings.maxInFlight, std::size_t(1));
+        m_settings.maxPending = (std::max)(m_settings.maxPending, std::size_t(1));
+        if (!m_settings.pool)
+        {
+            m_settings.pool = &WorkerPool::GetInstance();
+        }
+    }
+
+    void schedulePump()
+    {
+        auto self = shared_from_this();
+        TaskScheduler::GetInstance().ScheduleTask([self] { self->pump(); });
+    }
+
+    // Main thread. Issues requests until the window is full, the backlog is too long, or the range is done.
+    void pump()
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        const AEGP_PluginID pluginID = *SuiteManager::GetInstance().GetPluginID();
+        for (;;)
+        {
+            A_long frame = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_canceled || m_next > m_last || m_inFlight >= m_settings.maxInFlight ||
+                    m_pending >= m_settings.maxPending)
+                {
+                    break;
+                }
+                frame = m_next++;
+                ++m_inFlight;
+                ++m_submitted;
+                m_peakInFlight = (std::max)(m_peakInFlight, m_inFlight);
+            }
+
+            auto request = std::make_unique<Request>();
+            request->pipeline = weak_from_this();
+            request->frame = frame;
+            request->time = m_base.framesToTime(frame);
+            try
+            {
+                AE_CHECK(suites.LayerRenderOptionsSuite2()->AEGP_Duplicate(pluginID, m_options->get(),
+                                                                           &request->options));
+                AE_CHECK(suites.LayerRenderOptionsSuite2()->AEGP_SetTime(request->options, request->time));
+                request->issued = Clock::now();
+                const std::uintptr_t token = Registry::add(std::move(request));
+                AEGP_AsyncRequestId id = 0;
+                const A_Err err = suites.RenderSuite5()->AEGP_RenderAndCheckoutLayerFrame_Async(
+                    Registry::options(token), &RenderPipeline::OnFrameReady,
+                    reinterpret_cast<AEGP_AsyncFrameRequestRefcon>(token), &id);
+                if (err != A_Err_NONE)
+                {
+                    auto failed = Registry::take(token);
+                    if (failed)
+                    {
+                        suites.LayerRenderOptionsSuite2()->AEGP_Dispose(failed->options);
+                    }
+                    AE_CHECK(err);
+                }
+                Registry::setId(token, id, shared_from_this());
+            }
+            catch (...)
+            {
+                if (request && request->options)
+                {
+                    suites.LayerRenderOptionsSuite2()->AEGP_Dispose(request->options);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    --m_inFlight;
+                    ++m_failed;
+                }
+                notifyFailure(frame, false);
+            }
+        }
+        finishIfDone();
+    }
+
+    // Main thread, called by AE when a request finishes (possibly from inside AEGP_RenderAndCheckoutLayerFrame_Async).
+    static A_Err OnFrameReady(AEGP_AsyncRequestId, A_Boolean wasCanceled, A_Err error, AEGP_FrameReceiptH receipt,
+                              AEGP_AsyncFrameRequestRefcon refcon)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        std::unique_ptr<Request> request = Registry::take(reinterpret_cast<std::uintptr_t>(refcon));
+        if (!request)
+        {
+            return A_Err_NONE;
+        }
+        suites.LayerRenderOptionsSuite2()->AEGP_Dispose(request->options);
+        if (auto pipeline = request->pipeline.lock())
+        {
+            pipeline->frameReady(*request, wasCanceled != FALSE, error, receipt);
+        }
+        return A_Err_NONE;
+    }
+
+    void frameReady(const Request &request, bool wasCanceled, A_Err error, AEGP_FrameReceiptH receipt)
+    {
+        const double renderMs = millisecondsSince(request.issued);
+        RenderedFrame frame;
+        frame.frame = request.frame;
+        frame.time = request.time;
+        frame.renderMs = renderMs;
+        std::shared_ptr<Buffer> buffer;
+        bool ok = !wasCanceled && error == A_Err_NONE && receipt;
+        if (ok)
+        {
+            buffer = acquireBuffer();
+            ok = copyFrame(receipt, frame, *buffer);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_inFlight;
+            m_ids.erase(request.id);
+            if (!ok)
+            {
+                ++(wasCanceled ? m_canceledCount : m_failed);
+            }
+            else
+            {
+                ++m_pending;
+                m_renderMs.push_back(renderMs);
+            }
+        }
+
+        if (ok)
+        {
+            auto self = shared_from_this();
+            m_settings.pool->post([self, frame, buffer] { self->process(frame, buffer); });
+        }
+        else
+        {
+            if (buffer)
+            {
+                releaseBuffer(std::move(buffer));
+            }
+            notifyFailure(request.frame, wasCanceled);
+        }
+        pump();
+    }
+
+    // Worker thread.
+    void process(const RenderedFrame &frame, std::shared_ptr<Buffer> buffer)
+    {
+        const auto begin = Clock::now();
+        bool ok = true;
+        try
+        {
+            m_handler(frame);
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+        const double processMs = millisecondsSince(begin);
+        if (!ok)
+        {
+            notifyFailure(frame.frame, false);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+            ++(ok ? m_completed : m_failed);
+            m_processMs.push_back(processMs);
+        }
+        releaseBuffer(std::move(buffer));
+        schedulePump();
+    }
+
+    void notifyFailure(A_long frame, bool canceled)
+    {
+        if (m_onFailure)
+        {
+            try
+            {
+                m_onFailure(frame, canceled);
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    std::shared_ptr<Buffer> acquireBuffer()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeBuffers.empty())
+        {
+            return std::make_shared<Buffer>();
+        }
+        std::shared_ptr<Buffer> buffer = std::move(m_freeBuffers.back());
+        m_freeBuffers.pop_back();
+        return buffer;
+    }
+
+    void releaseBuffer(std::shared_ptr<Buffer> buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_freeBuffers.push_back(std::move(buffer));
+    }
+
+    // Main thread: copies the receipt's world into buffer, so the handler needs neither the receipt nor host calls.
+    static bool copyFrame(AEGP_FrameReceiptH receipt, RenderedFrame &frame, Buffer &buffer)
+    {
+        auto &suites = SuiteManager::GetInstance().GetSuiteHandler();
+        auto *worldSuite = suites.WorldSuite3();
+        AEGP_WorldH world = nullptr;
+        if (suites.RenderSuite5()->AEGP_GetReceiptWorld(receipt, &world) != A_Err_NONE || !world)
+        {
+            return false;
+        }
+        AEGP_WorldType type = AEGP_WorldType_NONE;
+        worldSuite->AEGP_GetType(world, &type);
+        A_u_long sourceRowBytes = 0;
+        worldSuite->AEGP_GetSize(world, &frame.width, &frame.height);
+        worldSuite->AEGP_GetRowBytes(world, &sourceRowBytes);
+        const void *source = nullptr;
+        switch (type)
+        {
+        case AEGP_WorldType_8: {
+            PF_Pixel8 *base = nullptr;
+            worldSuite->AEGP_GetBaseAddr8(world, &base);
+            source = base;
+            frame.bitDepth = 8;
+            break;
+        }
+        case AEGP_WorldType_16: {
+            PF_Pixel16 *base = nullptr;
+            worldSuite->AEGP_GetBaseAddr16(world, &base);
+            source = base;
+            frame.bitDepth = 16;
+            break;
+        }
+        case AEGP_WorldType_32: {
+            PF_PixelFloat *base = nullptr;
+            worldSuite->AEGP_GetBaseAddr32(world, &base);
+            source = base;
+            frame.bitDepth = 32;
+            break;
+        }
+        default:
+            return false;
+        }
+        if (!source || frame.width <= 0 || frame.height <= 0)
+        {
+            return false;
+        }
+
+        frame.rowBytes = static_cast<A_u_long>(frame.width) * (frame.bitDepth / 2); // 4 channels of bitDepth / 8 bytes
+        buffer.resize(static_cast<std::size_t>(frame.rowBytes) * frame.height);
+        const auto *sourceRow = static_cast<const std::uint8_t *>(source);
+        for (A_long y = 0; y < frame.height; ++y, sourceRow += sourceRowBytes)
+        {
+            std::memcpy(buffer.data() + static_cast<std::size_t>(y) * frame.rowBytes, sourceRow, frame.rowBytes);
+        }
+        frame.data = buffer.data();
+        return true;
+    }
+
+    // Main thread.
+    void cancelInFlight()
+    {
+        std::vector<AEGP_AsyncRequestId> ids;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ids.assign(m_ids.begin(), m_ids.end());
+        }
+        auto *renderSuite = SuiteManager::GetInstance().GetSuiteHandler().RenderSuite5();
+        for (AEGP_AsyncRequestId id : ids)
+        {
+            renderSuite->AEGP_CancelAsyncRequest(id);
+        }
+        finishIfDone();
+    }
+
+    void finishIfDone()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished || !m_started || m_inFlight > 0 || m_pending > 0 || (!m_canceled && m_next <= m_last))
+        {
+            return;
+        }
+        m_finished = true;
+        m_done.set_value(buildStats());
+    }
+
+    // Called with m_mutex held.
+    RenderStats buildStats() const
+    {
+        RenderStats stats;
+        stats.submitted = m_submitted;
+        stats.completed = m_completed;
+        stats.failed = m_failed;
+        stats.canceled = m_canceledCount;
+        stats.peakInFlight = m_peakInFlight;
+        summarize(m_renderMs, stats.renderMsMin, stats.renderMsMean, stats.renderMsP95, stats.renderMsMax);
+        summarize(m_processMs, stats.processMsMin, stats.processMsMean, stats.processMsP95, stats.processMsMax);
+        stats.elapsedMs = m_started ? millisecondsSince(m_startTime) : 0.0;
+        return stats;
+    }
+
+    static void summarize(std::vector<double> samples, double &min, double &mean, double &p95, double &max)
+    {
+        if (samples.empty())
+        {
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double sample : samples)
+        {
+            sum += sample;
+        }
+        min = samples.front();
+        max = samples.back();
+        mean = sum / samples.size();
+        p95 = samples[(std::min)(samples.size() - 1, samples.size() * 95 / 100)];
+    }
+
+    static double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /**
+     * Outstanding requests, keyed by the token passed to AE as the refcon. AE's callback may arrive after the
+     * pipeline is gone, so the refcon is a lookup key rather than an owning pointer: the callback always frees its
+     * entry and the duplicated options, whether or not the pipeline is still alive.
+     */
+    class Registry
+    {
+      public:
+        static std::uintptr_t add(std::unique_ptr<Request> request)
+        {
+            auto &registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            const std::uintptr_t token = ++registry.nextToken;
+            registry.requests.emplace(token, std::move(request));
+            return token;
+        }
+
+        static AEGP_LayerRenderOptionsH options(std::uintptr_t token)
+        {
+            auto &registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto it = registry.requests.find(token);
+            return it == registry.requests.end() ? nullptr : it->second->options;
+        }
+
+        // Records the AE id, unless the callback already ran inside the render call.
+        static void setId(std::uintptr_t token, AEGP_AsyncRequestId id, const std::shared_ptr<RenderPipeline> &owner)
+        {
+            auto &registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto it = registry.requests.find(token);
+            if (it != registry.requests.end())
+            {
+                it->second->id = id;
+                std::lock_guard<std::mutex> ownerLock(owner->m_mutex);
+                owner->m_ids.insert(id);
+            }
+        }
+
+        static std::unique_ptr<Request> take(std::uintptr_t token)
+        {
+            auto &registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto it = registry.requests.find(token);
+            if (it == registry.requests.end())
+            {
+                return nullptr;
+            }
+            std::unique_ptr<Request> request = std::move(it->second);
+            registry.requests.erase(it);
+            return request;
+        }
+
+      private:
+        static Registry &instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        std::mutex mutex;
+        std::uintptr_t nextToken = 0;
+        std::unordered_map<std::uintptr_t, std::unique_ptr<Request>> requests;
+    };
+
+    LayerRenderOptionsPtr m_options;
+    FrameHandler m_handler;
+    FailureHandler m_onFailure;
+    Options m_settings;
+    TimeBase m_base;
+
+    mutable std::mutex m_mutex;
+    std::promise<RenderStats> m_done;
+    bool m_started = false;
+    bool m_canceled = false;
+    bool m_finished = false;
+    A_long m_next = 0;
+    A_long m_last = -1;
+    std::size_t m_inFlight = 0;
+    std::size_t m_pending = 0;
+    std::size_t m_submitted = 0, m_completed = 0, m_failed = 0, m_canceledCount = 0, m_peakInFlight = 0;
+    std::unordered_set<AEGP_AsyncRequestId> m_ids;
+    std::vector<double> m_renderMs;
+    std::vector<double> m_processMs;
+    std::vector<std::shared_ptr<Buffer>> m_freeBuffers;
+    Clock::time_point m_startTime;
+};
+
+} // namespace ae
+
+#endif // RENDER_PIPELINE_HPP
@@ -0,0 +1,100 @@
+/*****************************************************************/ /**
+                                                                     * \file   Reorder.hpp
+                                                                     * \brief  Fewest single-element moves that turn
+                                                                     *one order into another.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef REORDER_HPP
+#define REORDER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @brief Computes the moves that turn current into target (both hold the same elements, e.g. a comp's layers).
+ *
+ * Each move is (element, index): take the element out and insert it at that index, as AEGP_ReorderLayer does.
+ * Applying the moves in order yields target.
+ *
+ * Elements on a longest increasing subsequence of target ranks are already in the right relative order and never
+ * move. Every other element is moved once, in target order, to just after the element that precedes it in target;
+ * that element is either on the subsequence or already placed, so each move is final. This makes n - LIS moves, the
+ * minimum for single-element moves.
+ */
+template <typename Handle>
+std::vector<std::pair<Handle, std::size_t>> MinimalReorders(const std::vector<Handle> &current,
+                                                           const std::vector<Handle> &target)
+{
+    const std::size_t count = current.size();
+    std::unordered_map<Handle, std::size_t> rankOf;
+    rankOf.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        rankOf.emplace(target[i], i);
+    }
+    std::vector<std::size_t> ranks(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ranks[i] = rankOf.at(current[i]);
+    }
+
+    // Longest increasing subsequence of ranks, O(n log n) patience sorting.
+    std::vector<std::size_t> tails; // tails[k]: position in current ending the best subsequence of length k + 1
+    std::vector<std::ptrdiff_t> before(count, -1);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto it = std::lower_bound(tails.begin(), tails.end(), ranks[i],
+                                   [&ranks](std::size_t position, std::size_t rank) { return ranks[position] < rank; });
+        if (it != tails.begin())
+        {
+            before[i] = static_cast<std::ptrdiff_t>(*(it - 1));
+        }
+        if (it == tails.end())
+        {
+            tails.push_back(i);
+        }
+        else
+        {
+            *it = i;
+        }
+    }
+    std::vector<bool> stays(count, false);
+    for (std::ptrdiff_t i = tails.empty() ? -1 : static_cast<std::ptrdiff_t>(tails.back()); i >= 0; i = before[i])
+    {
+        stays[ranks[i]] = true;
+    }
+
+    std::vector<std::pair<Handle, std::size_t>> moves;
+    moves.reserve(count - tails.size());
+    std::vector<Handle> order = current;
+    for (std::size_t rank = 0; rank < count; ++rank)
+    {
+        if (stays[rank])
+        {
+            continue;
+        }
+        const Handle &element = target[rank];
+        order.erase(std::find(order.begin(), order.end(), element));
+        std::size_t index = 0;
+        if (rank > 0)
+        {
+            auto previous = std::find(order.begin(), order.end(), target[rank - 1]);
+            index = static_cast<std::size_t>(previous - order.begin()) + 1;
+        }
+        order.insert(order.begin() + index, element);
+        moves.emplace_back(element, index);
+    }
+    return moves;
+}
+
+} // namespace ae
+
+#endif // REORDER_HPP
@@ -0,0 +1,276 @@
+/*****************************************************************/ /**
+                                                                     * \file   Swizzle.hpp
+                                                                     * \brief  Row kernels converting AE's ARGB pixels
+                                                                     *to RGBA/BGRA at 8, 16 and 32 bits.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef SWIZZLE_HPP
+#define SWIZZLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AETK_SWIZZLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ae
+{
+
+/**
+ * @brief Channel order of converted pixels. AE worlds are always ARGB.
+ */
+enum class ChannelOrder
+{
+    RGBA,
+    BGRA
+};
+
+/*
+ * Each kernel converts one row of `pixels` ARGB pixels. Rows never overlap and need no alignment. SSE2 (always
+ * present on x64) handles 16 bytes per step; the scalar loop handles the tail and other targets.
+ *
+ * 16 bit AE pixels run from 0 to 32768; the 16 bit kernels expand them to the full 0..65535 range.
+ */
+
+namespace detail
+{
+// 0..32768 -> 0..65535 as v * 2 - v / 32768, exact at both ends. Arithmetic wraps mod 2^16, like the SSE2 path.
+inline std::uint16_t Expand16(std::uint16_t v)
+{
+    v = (std::min)(v, std::uint16_t(32768));
+    return static_cast<std::uint16_t>((v << 1) - (v >> 15));
+}
+
+inline std::uint16_t SwapBytes16(std::uint16_t v)
+{
+    return static_cast<std::uint16_t>((v << 8) | (v >> 8));
+}
+
+// Index of the ARGB source channel written to output channel c.
+inline int SourceChannel(ChannelOrder order, int c)
+{
+    static const int rgba[4] = {1, 2, 3, 0};
+    static const int bgra[4] = {3, 2, 1, 0};
+    return order == ChannelOrder::RGBA ? rgba[c] : bgra[c];
+}
+
+template <ChannelOrder Order> void SwizzleRow8(const std::uint8_t *src, std::uint8_t *dst, std::size_t pixels)
+{
+    std::size_t i = 0;
+#ifdef AETK_SWIZZLE_SSE2
+    for (; i + 4 <= pixels; i += 4)
+    {
+        // Little-endian ARGB pixel: A | R << 8 | G << 16 | B << 24.
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        if (Order == ChannelOrder::RGBA)
+        {
+            v = _mm_or_si128(_mm_srli_epi32(v, 8), _mm_slli_epi32(v, 24)); // rotate right one byte
+        }
+        else
+        {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); // full byte reversal
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), v);
+    }
+#endif
+    for (; i < pixels; ++i)
+    {
+        const std::uint8_t *p = src + i * 4;
+        std::uint8_t *q = dst + i * 4;
+        for (int c = 0; c < 4; ++c)
+        {
+            q[c] = p[SourceChannel(Order, c)];
+        }
+    }
+}
+
+template <ChannelOrder Order>
+void SwizzleRow16(const std::uint16_t *src, std::uint16_t *dst, std::size_t pixels, bool bigEndian)
+{
+    std::size_t i = 0;
+#ifdef AETK_SWIZZLE_SSE2
+    const __m128i maxValue = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (; i + 2 <= pixels; i += 2)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        v = _mm_sub_epi16(v, _mm_subs_epu16(v, maxValue)); // unsigned min(v, 32768)
+        v = _mm_sub_epi16(_mm_slli_epi16(v, 1), _mm_srli_epi16(v, 15));
+        if (Order == ChannelOrder::RGBA)
+        {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 3, 2, 1)), _MM_SHUFFLE(0, 3, 2, 1));
+        }
+        else
+        {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        if (bigEndian)
+        {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), v);
+    }
+#endif
+    for (; i < pixels; ++i)
+    {
+        const std::uint16_t *p = src + i * 4;
+        std::uint16_t *q = dst + i * 4;
+        for (int c = 0; c < 4; ++c)
+        {
+            const std::uint16_t v = Expand16(p[SourceChannel(Order, c)]);
+            q[c] = bigEndian ? SwapBytes16(v) : v;
+        }
+    }
+}
+
+template <ChannelOrder Order> void SwizzleRow32(const float *src, float *dst, std::size_t pixels)
+{
+    std::size_t i = 0;
+#ifdef AETK_SWIZZLE_SSE2
+    for (; i < pixels; ++i)
+    {
+        __m128 v = _mm_loadu_ps(src + i * 4);
+        if (Order == ChannelOrder::RGBA)
+        {
+            v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 3, 2, 1));
+        }
+        else
+        {
+            v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        _mm_storeu_ps(dst + i * 4, v);
+    }
+#endif
+    for (; i < pixels; ++i)
+    {
+        const float *p = src + i * 4;
+        float *q = dst + i * 4;
+        for (int c = 0; c < 4; ++c)
+        {
+            q[c] = p[SourceChannel(Order, c)];
+        }
+    }
+}
+} // namespace detail
+
+/**
+ * @brief 8 bit ARGB to 8 bit RGBA/BGRA.
+ */
+inline void SwizzleRow8(const std::uint8_t *src, std::uint8_t *dst, std::size_t pixels,
+                        ChannelOrder order = ChannelOrder::RGBA)
+{
+    order == ChannelOrder::RGBA ? detail::SwizzleRow8<ChannelOrder::RGBA>(src, dst, pixels)
+                                : detail::SwizzleRow8<ChannelOrder::BGRA>(src, dst, pixels);
+}
+
+/**
+ * @brief 16 bit AE ARGB (0..32768) to full range 16 bit RGBA/BGRA, optionally big-endian (as PNG stores it).
+ */
+inline void SwizzleRow16(const std::uint16_t *src, std::uint16_t *dst, std::size_t pixels,
+                         ChannelOrder order = ChannelOrder::RGBA, bool bigEndian = false)
+{
+    order == ChannelOrder::RGBA ? detail::SwizzleRow16<ChannelOrder::RGBA>(src, dst, pixels, bigEndian)
+                                : detail::SwizzleRow16<ChannelOrder::BGRA>(src, dst, pixels, bigEndian);
+}
+
+/**
+ * @brief 32 bit float ARGB to float RGBA/BGRA. Values are copied unclamped.
+ */
+inline void SwizzleRow32(const float *src, float *dst, std::size_t pixels, ChannelOrder order = ChannelOrder::RGBA)
+{
+    order == ChannelOrder::RGBA ? detail::SwizzleRow32<ChannelOrder::RGBA>(src, dst, pixels)
+                                : detail::SwizzleRow32<ChannelOrder::BGRA>(src, dst, pixels);
+}
+
+/**
+ * @brief Converts one ARGB row of any AE depth to `outBitDepth` bits per channel (8 and 16 unsigned, 32 float).
+ *
+ * Same-depth conversions use the kernels above. Depth changes clamp floats to 0..1 and round to nearest. With
+ * outBitDepth 16, values are full range 0..65535.
+ */
+inline void ConvertRow(const void *src, int bitDepth, void *dst, int outBitDepth, std::size_t pixels,
+                       ChannelOrder order = ChannelOrder::RGBA, bool bigEndian = false)
+{
+    if (bitDepth == outBitDepth)
+    {
+        switch (bitDepth)
+        {
+        case 8:
+            SwizzleRow8(static_cast<const std::uint8_t *>(src), static_cast<std::uint8_t *>(dst), pixels, order);
+            return;
+        case 16:
+            SwizzleRow16(static_cast<const std::uint16_t *>(src), static_cast<std::uint16_t *>(dst), pixels, order,
+                         bigEndian);
+            return;
+        default:
+            SwizzleRow32(static_cast<const float *>(src), static_cast<float *>(dst), pixels, order);
+            return;
+        }
+    }
+
+    int channels[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        channels[c] = detail::SourceChannel(order, c);
+    }
+    for (std::size_t i = 0; i < pixels; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            const std::size_t from = i * 4 + channels[c];
+            float value; // normalized 0..1
+            switch (bitDepth)
+            {
+            case 8:
+                value = static_cast<const std::uint8_t *>(src)[from] * (1.0f / 255.0f);
+                break;
+            case 16:
+                value = static_cast<const std::uint16_t *>(src)[from] * (1.0f / 32768.0f);
+                break;
+            default:
+                value = static_cast<const float *>(src)[from];
+                break;
+            }
+            const std::size_t to = i * 4 + c;
+            if (outBitDepth == 32)
+            {
+                static_cast<float *>(dst)[to] = value;
+                continue;
+            }
+            value = (std::min)((std::max)(value, 0.0f), 1.0f);
+            if (outBitDepth == 8)
+            {
+                static_cast<std::uint8_t *>(dst)[to] = static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+            }
+            else
+            {
+                const auto v = static_cast<std::uint16_t>(value * 65535.0f + 0.5f);
+                static_cast<std::uint16_t *>(dst)[to] = bigEndian ? detail::SwapBytes16(v) : v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Converts `height` rows, honouring the row pitch of both sides (AE worlds are often padded).
+ */
+inline void ConvertRows(const void *src, std::size_t srcPitch, int bitDepth, void *dst, std::size_t dstPitch,
+                        int outBitDepth, std::size_t width, std::size_t height,
+                        ChannelOrder order = ChannelOrder::RGBA, bool bigEndian = false)
+{
+    const auto *from = static_cast<const std::uint8_t *>(src);
+    auto *to = static_cast<std::uint8_t *>(dst);
+    for (std::size_t y = 0; y < height; ++y, from += srcPitch, to += dstPitch)
+    {
+        ConvertRow(from, bitDepth, to, outBitDepth, width, order, bigEndian);
+    }
+}
+
+} // namespace ae
+
+#endif // SWIZZLE_HPP
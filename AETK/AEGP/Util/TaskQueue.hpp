@@ -0,0 +1,234 @@
+/*****************************************************************/ /**
+                                                                     * \file   TaskQueue.hpp
+                                                                     * \brief  Task storage and lock-free queue used by
+                                                                     *the TaskScheduler.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef TASK_QUEUE_HPP
+#define TASK_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ae
+{
+
+/**
+ * @class Task
+ * @brief Move-only, type-erased `void()` callable with small-buffer storage.
+ *
+ * Callables up to BufferSize bytes (lambdas with a few captures, std::packaged_task, ...) are stored inline, so
+ * queueing them does not allocate beyond the queue node itself. Larger callables fall back to the heap.
+ * Unlike std::function, move-only callables such as promises can be captured directly.
+ */
+class Task
+{
+  public:
+    static constexpr std::size_t BufferSize = 6 * sizeof(void *);
+
+    Task() noexcept = default;
+
+    template <typename Func, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, Task>>>
+    Task(Func &&func)
+    {
+        using Callable = std::decay_t<Func>;
+        if constexpr (sizeof(Callable) <= BufferSize && alignof(Callable) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Callable>)
+        {
+            ::new (static_cast<void *>(&m_storage)) Callable(std::forward<Func>(func));
+            m_ops = &InlineOps<Callable>::ops;
+        }
+        else
+        {
+            ::new (static_cast<void *>(&m_storage)) Callable *(new Callable(std::forward<Func>(func)));
+            m_ops = &HeapOps<Callable>::ops;
+        }
+    }
+
+    Task(Task &&other) noexcept { moveFrom(other); }
+
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { m_ops->invoke(&m_storage); }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    void reset() noexcept
+    {
+        if (m_ops)
+        {
+            m_ops->destroy(&m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+  private:
+    using Storage = std::aligned_storage_t<BufferSize, alignof(std::max_align_t)>;
+
+    struct Ops
+    {
+        void (*invoke)(void *);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *) noexcept;
+    };
+
+    template <typename Callable> struct InlineOps
+    {
+        static void invoke(void *p) { (*static_cast<Callable *>(p))(); }
+        static void move(void *dst, void *src) noexcept
+        {
+            ::new (dst) Callable(std::move(*static_cast<Callable *>(src)));
+            static_cast<Callable *>(src)->~Callable();
+        }
+        static void destroy(void *p) noexcept { static_cast<Callable *>(p)->~Callable(); }
+        static constexpr Ops ops{&invoke, &move, &destroy};
+    };
+
+    template <typename Callable> struct HeapOps
+    {
+        static void invoke(void *p) { (**static_cast<Callable **>(p))(); }
+        static void move(void *dst, void *src) noexcept
+        {
+            ::new (dst) Callable *(*static_cast<Callable **>(src));
+        }
+        static void destroy(void *p) noexcept { delete *static_cast<Callable **>(p); }
+        static constexpr Ops ops{&invoke, &move, &destroy};
+    };
+
+    void moveFrom(Task &other) noexcept
+    {
+        if (other.m_ops)
+        {
+            other.m_ops->move(&m_storage, &other.m_storage);
+            m_ops = std::exchange(other.m_ops, nullptr);
+        }
+    }
+
+    Storage m_storage;
+    const Ops *m_ops = nullptr;
+};
+
+/**
+ * @class MPSCQueue
+ * @brief Unbounded lock-free multi-producer single-consumer queue.
+ *
+ * Intrusive node-based queue (D. Vyukov): push() is a single atomic exchange and never blocks, so producers on
+ * worker threads do not contend with the consumer or with each other beyond that exchange. pop() must only be
+ * called from one thread at a time (for the TaskScheduler, AE's main thread).
+ *
+ * A push that is still in progress may briefly be invisible to pop(); the element shows up on the next pop.
+ */
+template <typename T> class MPSCQueue
+{
+  public:
+    MPSCQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MPSCQueue()
+    {
+        T value;
+        while (pop(value))
+        {
+        }
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    /**
+     * @brief Enqueues a value. Safe to call from any thread.
+     */
+    void push(T value)
+    {
+        m_size.fetch_add(1, std::memory_order_release);
+        pushNode(new Node(std::move(value)));
+    }
+
+    /**
+     * @brief Dequeues the oldest visible value. Consumer thread only.
+     * @return bool False if the queue is empty (or the next push has not completed yet).
+     */
+    bool pop(T &out)
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub)
+        {
+            if (!next)
+            {
+                return false;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (!next)
+        {
+            if (tail != m_head.load(std::memory_order_acquire))
+            {
+                return false; // a producer is between its exchange and its link
+            }
+            pushNode(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+            {
+                return false;
+            }
+        }
+        m_tail = next;
+        out = std::move(tail->value);
+        delete tail;
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued values.
+     */
+    std::size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    bool empty() const { return size() == 0; }
+
+  private:
+    struct Node
+    {
+        Node() = default;
+        explicit Node(T &&v) : value(std::move(v)) {}
+
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    void pushNode(Node *node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<Node *> m_head;
+    alignas(64) Node *m_tail;
+    std::atomic<std::size_t> m_size{0};
+    Node m_stub;
+};
+
+} // namespace ae
+
+#endif // TASK_QUEUE_HPP
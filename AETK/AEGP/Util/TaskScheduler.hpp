@@ -11,6 +11,12 @@
 #define TASK_SCHEDULER_HPP
 
 #include "AETK/Common/Common.hpp"
+#include "AETK/AEGP/Util/TaskQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
 
 /**
  * @class TaskScheduler
@@ -50,6 +56,18 @@
 namespace ae
 {
 
+/**
+ * @brief Priority lane a scheduled task is queued on.
+ *
+ * Interactive tasks (menu updates, UI-driven commands) are always drained before Bulk tasks, so a large background
+ * batch cannot delay them by more than the task currently running.
+ */
+enum class TaskPriority
+{
+    Interactive,
+    Bulk
+};
+
 class TaskScheduler
 {
   public:
@@ -65,14 +83,14 @@ class TaskScheduler
 
     /**
      * @brief Schedules a task with no return value.
-     * @param task The task to be scheduled.
+     * @param task The task to be scheduled. Any move-only `void()` callable is accepted.
      * @param callIdle Flag indicating whether to call idle routines for quicker
      * response.
+     * @param priority The lane to queue on. Defaults to the calling thread's priority (see ScopedTaskPriority).
      */
-    inline void ScheduleTask(std::function<void()> task, bool callIdle = true)
+    inline void ScheduleTask(Task task, bool callIdle = true, TaskPriority priority = CurrentPriority())
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        tasksQueue.push(std::move(task));
+        lane(priority).push(std::move(task));
         if (callIdle)
         {
             SuiteManager::GetInstance().GetSuiteHandler().UtilitySuite6()->AEGP_CauseIdleRoutinesToBeCalled();
@@ -91,42 +109,174 @@ class TaskScheduler
     template <typename ReturnType>
     std::future<ReturnType> ScheduleTask(std::function<ReturnType()> task, bool callIdle = true)
     {
-        auto promise = std::make_shared<std::promise<ReturnType>>();
-        auto future = promise->get_future();
+        std::promise<ReturnType> promise;
+        auto future = promise.get_future();
 
-        std::function<void()> taskWrapper = [promise, task]() {
-            try
-            {
-                promise->set_value(task());
-            }
-            catch (...)
-            {
-                promise->set_exception(std::current_exception());
-            }
-        };
-
-        ScheduleTask(taskWrapper, callIdle); // Schedule the wrapped task
+        ScheduleTask(Task([promise = std::move(promise), task = std::move(task)]() mutable {
+                         try
+                         {
+                             if constexpr (std::is_void_v<ReturnType>)
+                             {
+                                 task();
+                                 promise.set_value();
+                             }
+                             else
+                             {
+                                 promise.set_value(task());
+                             }
+                         }
+                         catch (...)
+                         {
+                             promise.set_exception(std::current_exception());
+                         }
+                     }),
+                     callIdle);
         return future;
     }
 
+    /**
+     * @brief Records the calling thread as AE's main thread.
+     *
+     * Called from the plugin entry point, which AE always invokes on the main thread. Until this has been called,
+     * IsMainThread() returns false and ScheduleOrExecute keeps routing calls through the queue.
+     */
+    inline void SetMainThread(std::thread::id id = std::this_thread::get_id()) { mainThreadId.store(id); }
 
     /**
-     * @brief Executes the next scheduled task.
+     * @brief Checks whether the calling thread is AE's main thread.
+     * @return bool True if called from the thread recorded by SetMainThread().
+     */
+    inline bool IsMainThread() const { return mainThreadId.load() == std::this_thread::get_id(); }
+
+    /**
+     * @brief Executes the next scheduled task, interactive lane first.
+     *
+     * Must only be called from the main thread (the queues have a single consumer).
      */
     inline void ExecuteTask()
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        if (!tasksQueue.empty())
+        Task task;
+        if (NextTask(task))
         {
-            auto task = tasksQueue.front();
-            tasksQueue.pop();
             task(); // Execute the task
         }
     }
 
+    /**
+     * @brief Executes scheduled tasks until the queues are empty or the time budget is used up.
+     *
+     * This is the drain mode used by Plugin::IdleHook. At least one task runs per call, so a single long task
+     * cannot stall the queue. The interactive lane is checked before every task, so interactive work queued while
+     * a bulk batch drains runs next.
+     *
+     * @param max_sleepPL AE's idle sleep hint (may be null). It is lowered to the busy sleep while tasks remain
+     * and raised to the idle sleep once the queue is empty.
+     * @return std::size_t The number of tasks executed.
+     */
+    inline std::size_t ExecuteTasks(A_long *max_sleepPL = nullptr)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeBudget.load();
+        std::size_t executed = 0;
+        Task task;
+        do
+        {
+            if (!NextTask(task))
+            {
+                break;
+            }
+            ++executed;
+            task();
+            task.reset();
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        if (max_sleepPL)
+        {
+            *max_sleepPL = HasPendingTasks() ? busySleep.load() : idleSleep.load();
+        }
+        return executed;
+    }
+
+    /**
+     * @brief Checks whether any tasks are waiting to be executed.
+     */
+    inline bool HasPendingTasks() const { return !interactiveQueue.empty() || !bulkQueue.empty(); }
+
+    /**
+     * @brief Approximate number of tasks waiting on a lane.
+     */
+    inline std::size_t PendingTasks(TaskPriority priority) const
+    {
+        return priority == TaskPriority::Interactive ? interactiveQueue.size() : bulkQueue.size();
+    }
+
+    /**
+     * @brief Sets how long ExecuteTasks may keep draining the queue per idle call.
+     * @param budget The time budget. Defaults to 8 ms.
+     */
+    inline void SetTimeBudget(std::chrono::microseconds budget) { timeBudget.store(budget); }
+
+    /**
+     * @brief Sets the sleep hints (in milliseconds) handed back to AE from the idle hook.
+     * @param busy Sleep while tasks are pending. Defaults to 0 so AE calls back as soon as possible.
+     * @param idle Sleep once the queue is empty. Defaults to 250; ScheduleTask wakes AE early when needed.
+     */
+    inline void SetIdleSleep(A_long busy, A_long idle)
+    {
+        busySleep.store(busy);
+        idleSleep.store(idle);
+    }
+
+    /**
+     * @brief The lane tasks scheduled from the calling thread go to by default.
+     */
+    static TaskPriority &CurrentPriority()
+    {
+        thread_local TaskPriority priority = TaskPriority::Interactive;
+        return priority;
+    }
+
   private:
-    std::mutex queueMutex;
-    std::queue<std::function<void()>> tasksQueue;
+    inline MPSCQueue<Task> &lane(TaskPriority priority)
+    {
+        return priority == TaskPriority::Interactive ? interactiveQueue : bulkQueue;
+    }
+
+    inline bool NextTask(Task &task) { return interactiveQueue.pop(task) || bulkQueue.pop(task); }
+
+    MPSCQueue<Task> interactiveQueue;
+    MPSCQueue<Task> bulkQueue;
+    std::atomic<std::thread::id> mainThreadId{};
+    std::atomic<std::chrono::microseconds> timeBudget{std::chrono::milliseconds(8)};
+    std::atomic<A_long> busySleep{0};
+    std::atomic<A_long> idleSleep{250};
+};
+
+/**
+ * @class ScopedTaskPriority
+ * @brief Sets the default lane for tasks scheduled from the current thread for the lifetime of the guard.
+ *
+ * Usage Example:
+ * ```
+ * std::thread([] {
+ *     ae::ScopedTaskPriority bulk(ae::TaskPriority::Bulk);
+ *     for (auto &layer : layers) layer->setName("..."); // queued behind any interactive work
+ * }).detach();
+ * ```
+ */
+class ScopedTaskPriority
+{
+  public:
+    explicit ScopedTaskPriority(TaskPriority priority) : m_previous(TaskScheduler::CurrentPriority())
+    {
+        TaskScheduler::CurrentPriority() = priority;
+    }
+    ~ScopedTaskPriority() { TaskScheduler::CurrentPriority() = m_previous; }
+
+    ScopedTaskPriority(const ScopedTaskPriority &) = delete;
+    ScopedTaskPriority &operator=(const ScopedTaskPriority &) = delete;
+
+  private:
+    TaskPriority m_previous;
 };
 } // namespace ae
 /**
@@ -141,7 +291,7 @@ class TaskScheduler
 template <typename ReturnType>
 inline std::future<ReturnType> ScheduleTask(std::function<ReturnType()> task, bool callIdle = true)
 {
-    return ae::TaskScheduler::GetInstance().ScheduleTask(task, callIdle);
+    return ae::TaskScheduler::GetInstance().ScheduleTask(std::move(task), callIdle);
 }
 
 /**
@@ -150,44 +300,171 @@ inline std::future<ReturnType> ScheduleTask(std::function<ReturnType()> task, bo
  * @param callIdle Flag indicating whether to call idle routines for quicker
  * response.
  */
-inline void ScheduleTask(std::function<void()> task, bool callIdle = true)
+inline void ScheduleTask(ae::Task task, bool callIdle = true)
 {
-    ae::TaskScheduler::GetInstance().ScheduleTask(task, callIdle);
+    ae::TaskScheduler::GetInstance().ScheduleTask(std::move(task), callIdle);
 }
 
 namespace ae
 {
 
-template <typename Func> auto ScheduleOrExecute(Func &&func)
+/**
+ * @brief Checks whether the calling thread is AE's main thread.
+ */
+inline bool IsMainThread()
 {
-    using ReturnType = typename std::invoke_result<Func>::type;
+    return TaskScheduler::GetInstance().IsMainThread();
+}
 
-    auto taskPtr = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(func));
-    auto future = taskPtr->get_future();
+/**
+ * @class TaskResult
+ * @brief Result of ScheduleOrExecute.
+ *
+ * Behaves like a std::future (get/wait/valid), but when the call ran inline on the main thread the value is stored
+ * directly, so the common case does not allocate a shared state, a packaged_task or a queue node.
+ * Exceptions thrown by the task are rethrown from get(), just as with a future.
+ */
+template <typename ReturnType> class TaskResult
+{
+  public:
+    TaskResult() = default;
+    explicit TaskResult(std::future<ReturnType> future) : m_future(std::move(future)) {}
 
-#ifdef TK_INTERNAL
-    TaskScheduler::GetInstance().ScheduleTask([taskPtr]() {
+    /**
+     * @brief Runs func on the calling thread and stores its result or exception.
+     */
+    template <typename Func> static TaskResult invoke(Func &&func)
+    {
+        TaskResult result;
         try
         {
-            (*taskPtr)();
+            result.m_value.emplace(std::forward<Func>(func)());
         }
         catch (...)
         {
-            // Log the exception here if needed
+            result.m_error = std::current_exception();
         }
-    });
-#else
-    try
+        return result;
+    }
+
+    ReturnType get()
     {
-        (*taskPtr)();
+        if (m_future.valid())
+        {
+            return m_future.get();
+        }
+        if (m_error)
+        {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+        if (!m_value)
+        {
+            throw std::future_error(std::future_errc::no_state);
+        }
+        ReturnType value = std::move(*m_value);
+        m_value.reset();
+        return value;
     }
-    catch (...)
+
+    void wait() const
     {
-        // Log or handle the immediate exception if needed
+        if (m_future.valid())
+        {
+            m_future.wait();
+        }
+    }
+
+    bool valid() const { return m_future.valid() || m_value.has_value() || m_error; }
+
+  private:
+    std::optional<ReturnType> m_value;
+    std::exception_ptr m_error;
+    std::future<ReturnType> m_future;
+};
+
+template <> class TaskResult<void>
+{
+  public:
+    TaskResult() = default;
+    explicit TaskResult(std::future<void> future) : m_future(std::move(future)) {}
+
+    template <typename Func> static TaskResult invoke(Func &&func)
+    {
+        TaskResult result;
+        try
+        {
+            std::forward<Func>(func)();
+        }
+        catch (...)
+        {
+            result.m_error = std::current_exception();
+        }
+        result.m_done = true;
+        return result;
+    }
+
+    void get()
+    {
+        if (m_future.valid())
+        {
+            m_future.get();
+            return;
+        }
+        if (m_error)
+        {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+        m_done = false;
     }
-#endif
 
-    return future;
+    void wait() const
+    {
+        if (m_future.valid())
+        {
+            m_future.wait();
+        }
+    }
+
+    bool valid() const { return m_future.valid() || m_done; }
+
+  private:
+    bool m_done = false;
+    std::exception_ptr m_error;
+    std::future<void> m_future;
+};
+
+/**
+ * @brief Runs func on AE's main thread.
+ *
+ * If the caller already is on the main thread (hooks, idle tasks, nested wrapper calls), func is invoked inline and
+ * its result is returned directly. Only calls from other threads are queued on the TaskScheduler.
+ *
+ * @return TaskResult<ReturnType> Use get() or wait() as with a std::future.
+ */
+template <typename Func> auto ScheduleOrExecute(Func &&func)
+{
+    using ReturnType = typename std::invoke_result<Func>::type;
+
+#ifdef TK_INTERNAL
+    if (!IsMainThread())
+    {
+        std::packaged_task<ReturnType()> task(std::forward<Func>(func));
+        TaskResult<ReturnType> result(task.get_future());
+
+        TaskScheduler::GetInstance().ScheduleTask([task = std::move(task)]() mutable {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                // Log the exception here if needed
+            }
+        });
+        return result;
+    }
+#endif
+    return TaskResult<ReturnType>::invoke(std::forward<Func>(func));
 }
 
 } // namespace ae
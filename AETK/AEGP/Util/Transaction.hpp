@@ -0,0 +1,160 @@
+/*****************************************************************/ /**
+                                                                     * \file   Transaction.hpp
+                                                                     * \brief  Batching many suite calls into a single
+                                                                     *main-thread task.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+
+#ifndef TRANSACTION_HPP
+#define TRANSACTION_HPP
+
+#include "AETK/AEGP/Core/Core.hpp"
+#include "AETK/AEGP/Util/Context.hpp"
+
+namespace ae
+{
+
+namespace detail
+{
+template <typename ReturnType, typename Func> void FulfillPromise(std::promise<ReturnType> &promise, Func &func)
+{
+    try
+    {
+        if constexpr (std::is_void_v<ReturnType>)
+        {
+            func();
+            promise.set_value();
+        }
+        else
+        {
+            promise.set_value(func());
+        }
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Runs func as a single task on AE's main thread.
+ *
+ * Every AETK wrapper call made inside func runs inline (it is already on the main thread), so a worker thread that
+ * needs hundreds of suite calls pays for one idle round trip instead of one per call. Called from the main thread
+ * (including from inside another batch), func runs immediately.
+ *
+ * @param func The work to run. May return a value.
+ * @param undoName If not empty, func runs inside a Scoped_Undo_Guard with this name.
+ * @param callIdle Flag indicating whether to call idle routines for quicker response.
+ * @return std::future<ReturnType> One future for the whole batch; exceptions thrown by func are rethrown from get().
+ *
+ * @example
+ * std::thread([comp] {
+ *     auto names = ae::batch([&] {
+ *         std::vector<std::string> result;
+ *         for (auto &layer : *comp->layers())
+ *             result.push_back(layer->getName());
+ *         return result;
+ *     }).get();
+ * }).detach();
+ */
+template <typename Func>
+auto batch(Func &&func, std::string undoName = "", bool callIdle = true)
+    -> std::future<std::invoke_result_t<std::decay_t<Func> &>>
+{
+    using ReturnType = std::invoke_result_t<std::decay_t<Func> &>;
+
+    std::promise<ReturnType> promise;
+    auto future = promise.get_future();
+
+    auto body = [func = std::forward<Func>(func), undoName = std::move(undoName),
+                 promise = std::move(promise)]() mutable {
+        auto scoped = [&]() -> ReturnType {
+            std::optional<Scoped_Undo_Guard> undo;
+            if (!undoName.empty())
+            {
+                undo.emplace(undoName);
+            }
+            return func();
+        };
+        detail::FulfillPromise(promise, scoped);
+    };
+
+#ifdef TK_INTERNAL
+    if (!IsMainThread())
+    {
+        TaskScheduler::GetInstance().ScheduleTask(std::move(body), callIdle);
+        return future;
+    }
+#endif
+    body();
+    return future;
+}
+
+/**
+ * @class Transaction
+ * @brief Collects steps and commits them as one batch on the main thread.
+ *
+ * Steps run in the order they were added, inside one undo group when a name is given. If a step throws, the
+ * remaining steps are skipped and the exception is delivered through the future returned by commit().
+ *
+ * @example
+ * ae::Transaction tx("Rename Layers");
+ * for (auto &layer : layers)
+ *     tx.then([layer] { layer->setName(layer->getName() + "_old"); });
+ * tx.commit().get();
+ */
+class Transaction
+{
+  public:
+    explicit Transaction(std::string undoName = "") : m_undoName(std::move(undoName)) {}
+
+    Transaction(const Transaction &) = delete;
+    Transaction &operator=(const Transaction &) = delete;
+    Transaction(Transaction &&) = default;
+    Transaction &operator=(Transaction &&) = default;
+
+    /**
+     * @brief Adds a step to the transaction.
+     * @param step A `void()` callable.
+     */
+    template <typename Func> Transaction &then(Func &&step)
+    {
+        m_steps.emplace_back(std::forward<Func>(step));
+        return *this;
+    }
+
+    /**
+     * @brief The number of steps added so far.
+     */
+    std::size_t size() const { return m_steps.size(); }
+
+    /**
+     * @brief Runs all steps as a single main-thread task. The transaction is empty afterwards.
+     * @return std::future<void> Ready once every step has run.
+     */
+    std::future<void> commit(bool callIdle = true)
+    {
+        std::vector<Task> steps;
+        steps.swap(m_steps);
+        return batch(
+            [steps = std::move(steps)]() mutable {
+                for (auto &step : steps)
+                {
+                    step();
+                }
+            },
+            m_undoName, callIdle);
+    }
+
+  private:
+    std::string m_undoName;
+    std::vector<Task> m_steps;
+};
+
+} // namespace ae
+
+#endif // TRANSACTION_HPP
@@ -0,0 +1,152 @@
+/*****************************************************************/ /**
+                                                                     * \file   WorkerPool.hpp
+                                                                     * \brief  Small fixed-size thread pool for CPU work
+                                                                     *that does not touch the AE SDK.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include "AETK/AEGP/Util/TaskQueue.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ae
+{
+
+/**
+ * @class WorkerPool
+ * @brief Runs tasks on a fixed set of background threads.
+ *
+ * The counterpart of the TaskScheduler: the scheduler moves work onto AE's main thread, the pool moves CPU-bound
+ * work (encoding, pixel conversion, parsing) off it. Tasks posted here must not call AE suites directly; use
+ * ae::ScheduleOrExecute or ae::batch from inside them instead.
+ */
+class WorkerPool
+{
+  public:
+    /**
+     * @brief Gets the shared pool, sized to the hardware concurrency (at least two threads).
+     */
+    static WorkerPool &GetInstance()
+    {
+        static WorkerPool instance((std::max)(2u, std::thread::hardware_concurrency()));
+        return instance;
+    }
+
+    explicit WorkerPool(unsigned threadCount)
+    {
+        m_threads.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_all();
+        for (auto &thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * @brief Queues a task to run on one of the pool threads.
+     */
+    void post(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_ready.notify_one();
+    }
+
+    /**
+     * @brief Queues a callable and returns a future for its result.
+     */
+    template <typename Func> auto submit(Func &&func) -> std::future<std::invoke_result_t<std::decay_t<Func> &>>
+    {
+        using ReturnType = std::invoke_result_t<std::decay_t<Func> &>;
+        std::promise<ReturnType> promise;
+        auto future = promise.get_future();
+        post([func = std::forward<Func>(func), promise = std::move(promise)]() mutable {
+            try
+            {
+                if constexpr (std::is_void_v<ReturnType>)
+                {
+                    func();
+                    promise.set_value();
+                }
+                else
+                {
+                    promise.set_value(func());
+                }
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    std::size_t size() const { return m_threads.size(); }
+
+  private:
+    void run()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_ready.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                {
+                    return; // stopping and drained
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                // Tasks report their own errors (see submit); never let one take down a pool thread.
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<Task> m_tasks;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace ae
+
+#endif // WORKER_POOL_HPP
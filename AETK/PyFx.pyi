@@ -669,6 +669,33 @@ class PlatformWorldPtr(AEHandle):
 class ItemViewPtr(AEHandle):
     pass
 
+class ImageView8:
+    """(height, width, 4) ARGB uint8 buffer sharing the world's pixels; use numpy.asarray(view)."""
+    width: int
+    height: int
+    rowBytes: int
+    bitDepth: int
+    def subview(self, x: int, y: int, width: int, height: int) -> "ImageView8": ...
+
+class ImageView16:
+    """(height, width, 4) ARGB uint16 buffer (0..32768) sharing the world's pixels."""
+    width: int
+    height: int
+    rowBytes: int
+    bitDepth: int
+    def subview(self, x: int, y: int, width: int, height: int) -> "ImageView16": ...
+
+class ImageViewFloat:
+    """(height, width, 4) ARGB float32 buffer sharing the world's pixels."""
+    width: int
+    height: int
+    rowBytes: int
+    bitDepth: int
+    def subview(self, x: int, y: int, width: int, height: int) -> "ImageViewFloat": ...
+
+def viewWorld(world: WorldPtr) -> Union[ImageView8, ImageView16, ImageViewFloat]:
+    pass
+
 class ColorProfilePtr(AEHandle):
     pass
 
@@ -897,6 +924,46 @@ class Time():
     def to_frames(self) -> int:
         pass
 
+
+class TimeBase():
+    """A comp's exact frame duration; converts between seconds, frames and Time without host calls."""
+    def __init__(self, frameValue: int = 1, frameScale: int = 30):
+        pass
+
+    @staticmethod
+    def fromFrameRate(numerator: int, denominator: int = 1) -> 'TimeBase':
+        pass
+
+    @staticmethod
+    def fromComp(comp: CompPtr) -> 'TimeBase':
+        pass
+
+    @staticmethod
+    def fromLayer(layer: LayerPtr) -> 'TimeBase':
+        pass
+
+    @staticmethod
+    def mostRecent() -> 'TimeBase':
+        pass
+
+    def frameRate(self) -> float:
+        pass
+
+    def frameDuration(self) -> Time:
+        pass
+
+    def framesToTime(self, frames: int) -> Time:
+        pass
+
+    def timeToFrames(self, time: Time) -> int:
+        pass
+
+    def secondsToTime(self, seconds: float) -> Time:
+        pass
+
+    def secondsToFrames(self, seconds: float) -> int:
+        pass
+
     
 class Ratio():
     def __init__(self, num=0, den=1):
@@ -1238,6 +1305,33 @@ class SoundDataSuite:
     def GetNumSamples(self, soundData: SoundDataPtr) -> int:
         pass
 
+class ProjectIndex:
+    """Snapshot of the project's item tree, built with a single walk."""
+    @staticmethod
+    def build(projectIndex: int = 0) -> 'ProjectIndex':
+        pass
+
+    def __len__(self) -> int:
+        pass
+
+    def root(self) -> ItemPtr:
+        pass
+
+    def children(self, folder: ItemPtr) -> list[ItemPtr]:
+        pass
+
+    def findByName(self, name: str) -> list[ItemPtr]:
+        pass
+
+    def ofType(self, type: ItemType) -> list[ItemPtr]:
+        pass
+
+    def findById(self, id: int) -> ItemPtr:
+        pass
+
+    def getItemType(self, item: ItemPtr) -> ItemType:
+        pass
+
 class CompSuite:
     def __init__(self):
         pass
@@ -10,16 +10,17 @@ class ItemCollection(list):
         super().__init__()
 
     @classmethod 
-    def create(cls, root_folder: PyFx.ItemPtr) -> 'ItemCollection':
+    def create(cls, root_folder: PyFx.ItemPtr, index: PyFx.ProjectIndex = None) -> 'ItemCollection':
         collection = cls()
-        current_item = root_folder
         cls._ROOT_FOLDER = root_folder
-        proj = PyFx.ProjSuite().GetProjectByIndex(0)
-        while current_item:
-            if PyFx.ItemSuite().GetItemParentFolder(current_item) == root_folder:
-                item = ItemFactory.create_item(current_item)
-                collection.append(item)
-            current_item = PyFx.ItemSuite().GetNextProjItem(proj, current_item)
+        if index is None:
+            index = PyFx.ProjectIndex.build() #one walk over the project, shared with every subfolder below
+        for item in index.children(root_folder):
+            #the items are already in this folder, so skip append's reparenting
+            child = ItemFactory.create_item(item, index.getItemType(item))
+            if isinstance(child, FolderItem):
+                child._index = index #children() reuses it instead of walking the project again
+            list.append(collection, child)
         return collection
     
     def __getitem__(self, key: any) -> Item:
@@ -139,7 +139,8 @@ class FolderItem(Item):
         
     @property
     def children(self) -> 'ItemCollection':
-        return ItemCollection.create(self.item)
+        #folders listed by an ItemCollection share its project index; others build one
+        return ItemCollection.create(self.item, getattr(self, '_index', None))
     
     def add_item(self, item: Item) -> None:
         PyFx.ItemSuite().SetItemParentFolder(item.item, self.item)
@@ -272,8 +273,9 @@ class ItemFactory:
     Factory class for creating Item objects.
     """
     @staticmethod
-    def create_item(item: PyFx.ItemPtr) -> Union[Item, FolderItem, CompItem, FootageItem]:
-        type = PyFx.ItemSuite().GetItemType(item) #get the item type
+    def create_item(item: PyFx.ItemPtr, type: PyFx.ItemType = None) -> Union[Item, FolderItem, CompItem, FootageItem]:
+        if type is None:
+            type = PyFx.ItemSuite().GetItemType(item) #get the item type
         if type == PyFx.ItemType.FOLDER: 
             return FolderItem(item)
         elif type == PyFx.ItemType.COMP:
@@ -184,7 +184,8 @@ class FolderItem(Item):
         
     @property
     def children(self) -> 'ItemCollection':
-        return ItemCollection.create(self.item)
+        #folders listed by an ItemCollection share its project index; others build one
+        return ItemCollection.create(self.item, getattr(self, '_index', None))
     
     def add_item(self, item: Item) -> None:
         self._suite.SetItemParentFolder(item.item, self.item)
@@ -318,8 +319,9 @@ class ItemFactory:
     Factory class for creating Item objects.
     """
     @staticmethod
-    def create_item(item: PyFx.ItemPtr) -> Union[Item, FolderItem, CompItem, FootageItem]:
-        type = PyFx.ItemSuite().GetItemType(item) #get the item type
+    def create_item(item: PyFx.ItemPtr, type: PyFx.ItemType = None) -> Union[Item, FolderItem, CompItem, FootageItem]:
+        if type is None:
+            type = PyFx.ItemSuite().GetItemType(item) #get the item type
         if type == PyFx.ItemType.FOLDER: 
             return FolderItem(item)
         elif type == PyFx.ItemType.COMP:
@@ -335,16 +337,17 @@ class ItemCollection(list):
         super().__init__()
 
     @classmethod 
-    def create(cls, root_folder: PyFx.ItemPtr) -> 'ItemCollection':
+    def create(cls, root_folder: PyFx.ItemPtr, index: PyFx.ProjectIndex = None) -> 'ItemCollection':
         collection = cls()
-        current_item = root_folder
         cls._ROOT_FOLDER = root_folder
-        proj = PyFx.ProjSuite().GetProjectByIndex(0)
-        while current_item:
-            if PyFx.ItemSuite().GetItemParentFolder(current_item) == root_folder:
-                item = ItemFactory.create_item(current_item)
-                collection.append(item)
-            current_item = PyFx.ItemSuite().GetNextProjItem(proj, current_item)
+        if index is None:
+            index = PyFx.ProjectIndex.build() #one walk over the project, shared with every subfolder below
+        for item in index.children(root_folder):
+            #the items are already in this folder, so skip append's reparenting
+            child = ItemFactory.create_item(item, index.getItemType(item))
+            if isinstance(child, FolderItem):
+                child._index = index #children() reuses it instead of walking the project again
+            list.append(collection, child)
         return collection
     
     def __getitem__(self, key: any) -> Item:
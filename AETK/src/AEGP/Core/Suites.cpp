@@ -956,7 +956,7 @@ Time CompSuite::GetCompFrameDuration(CompPtr comp)
         CheckNotNull(comp->get(), "Error Getting Comp Frame Duration. Comp is Null");
         Time frameDuration;
         AE_CHECK(SuiteManager::GetInstance().GetSuiteHandler().CompSuite11()->AEGP_GetCompFrameDuration(
-            *comp, &frameDuration.toAEGP()));
+            *comp, &frameDuration.value));
         return frameDuration;
     });
     return future.get();
@@ -191,7 +191,7 @@ FolderItem FolderItem::create(const std::string &name, tk::shared_ptr<Item> pare
 tk::shared_ptr<ItemCollection> FolderItem::children()
 {
     if (!m_children) {
-		m_children = std::make_shared<ItemCollection>(std::make_shared<FolderItem>(m_item));
+		m_children = std::make_shared<ItemCollection>(std::make_shared<FolderItem>(m_item), m_index);
 	}
     return m_children;
 }
@@ -6,8 +6,14 @@
 
 tk::shared_ptr<BaseProperty> Layer::getProperty(LayerStream stream)
 {
-    auto property = StreamSuite().GetNewLayerStream(m_layer, stream);
-    return PropertyFactory::CreateProperty(property);
+    return m_cache.byLayerStream(stream, [this, stream] {
+        auto property = PropertyFactory::CreateProperty(StreamSuite().GetNewLayerStream(m_layer, stream));
+        if (property)
+        {
+            property->inheritTimeBase(*this);
+        }
+        return property;
+    });
 }
 
 tk::shared_ptr<ThreeDProperty> Layer::Position()
@@ -291,7 +297,7 @@ double Layer::offset()
 
 void Layer::setOffset(double offset)
 {
-    LayerSuite().SetLayerOffset(m_layer, SecondsToTime(offset));
+    LayerSuite().SetLayerOffset(m_layer, timeBase().secondsToTime(offset));
 }
 
 double Layer::inPoint()
@@ -302,7 +308,7 @@ double Layer::inPoint()
 
 void Layer::setInPoint(double inPoint)
 {
-    LayerSuite().SetLayerInPointAndDuration(m_layer, LTimeMode::CompTime, SecondsToTime(inPoint),
+    LayerSuite().SetLayerInPointAndDuration(m_layer, LTimeMode::CompTime, timeBase().secondsToTime(inPoint),
                                             LayerSuite().GetLayerDuration(m_layer, LTimeMode::CompTime));
 }
 
@@ -67,15 +67,19 @@ tk::vector<tk::shared_ptr<Item>> ItemCollection::slice(int start)
 
 void ItemCollection::createCollection()
 {
-    auto proj = ProjSuite().GetProjectByIndex(0);
-    auto currentItem = this->baseItem->getItem();
-    while (&currentItem != NULL)
+    if (!m_index)
     {
-        if (ItemSuite().GetItemParentFolder(currentItem) == baseItem->getItem())
+        m_index = ae::ProjectIndex::build();
+    }
+    for (auto index : m_index->children(baseItem->getItem()->get()))
+    {
+        const auto &entry = m_index->entry(index);
+        auto item = ItemFactory::createItem(ae::ProjectIndex::itemPtr(entry), entry.type);
+        if (auto folder = std::dynamic_pointer_cast<FolderItem>(item))
         {
-            m_collection.push_back(ItemFactory::createItem(currentItem));
+            folder->setProjectIndex(m_index);
         }
-        currentItem = ItemSuite().GetNextProjItem(proj, currentItem);
+        m_collection.push_back(item);
     }
 }
 
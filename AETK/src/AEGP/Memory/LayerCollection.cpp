@@ -1,6 +1,10 @@
 #include "AETK/AEGP/Template/LayerCollection.hpp"
 #include "AETK/AEGP/Items.hpp"
 #include "AETK/AEGP/Layers.hpp"
+#include "AETK/AEGP/Util/Reorder.hpp"
+#include "AETK/AEGP/Util/Transaction.hpp"
+
+#include <unordered_map>
 
 //    tk::shared_ptr<CompItem> baseComp;
 void LayerCollection::append(tk::shared_ptr<Item> item)
@@ -73,29 +77,79 @@ tk::vector<tk::shared_ptr<Layer>> LayerCollection::slice(int start)
     return newCollection;
 }
 
-void LayerCollection::reverse()
+void LayerCollection::reorder(const std::function<tk::vector<tk::shared_ptr<Layer>>()> &makeTarget,
+                              const std::string &undoName)
 {
-    for (int i = 0; i < m_collection.size(); i++)
+    if (m_collection.size() < 2)
     {
-        LayerSuite().ReorderLayer(m_collection[i]->getLayer(), static_cast<int>(m_collection.size()) - i);
+        m_collection = makeTarget();
+        return;
     }
-    std::reverse(m_collection.begin(), m_collection.end());
+    CompPtr comp = baseComp ? baseComp : LayerSuite().GetLayerParentComp(m_collection.front()->getLayer());
+
+    tk::vector<tk::shared_ptr<Layer>> target;
+    ae::batch(
+        [&] {
+            target = makeTarget();
+            auto *layerSuite = SuiteManager::GetInstance().GetSuiteHandler().LayerSuite9();
+            A_long numLayers = 0;
+            AE_CHECK(layerSuite->AEGP_GetCompNumLayers(comp->get(), &numLayers));
+            std::vector<AEGP_LayerH> current(numLayers);
+            for (A_long i = 0; i < numLayers; ++i)
+            {
+                AE_CHECK(layerSuite->AEGP_GetCompLayerByIndex(comp->get(), i, &current[i]));
+            }
+
+            // The collection's layers keep the comp slots they occupy now; only their order within them changes.
+            std::unordered_map<AEGP_LayerH, std::size_t> slotOf;
+            for (std::size_t i = 0; i < current.size(); ++i)
+            {
+                slotOf.emplace(current[i], i);
+            }
+            std::vector<std::size_t> slots;
+            slots.reserve(target.size());
+            for (const auto &layer : target)
+            {
+                auto it = slotOf.find(layer->getLayer()->get());
+                if (it == slotOf.end())
+                {
+                    throw AEException("Error Reordering Layers. All layers must belong to the same comp");
+                }
+                slots.push_back(it->second);
+            }
+            std::sort(slots.begin(), slots.end());
+            std::vector<AEGP_LayerH> wanted = current;
+            for (std::size_t i = 0; i < target.size(); ++i)
+            {
+                wanted[slots[i]] = target[i]->getLayer()->get();
+            }
+
+            for (const auto &move : ae::MinimalReorders(current, wanted))
+            {
+                AE_CHECK(layerSuite->AEGP_ReorderLayer(move.first, static_cast<A_long>(move.second)));
+            }
+        },
+        undoName)
+        .get();
+    m_collection = target;
+}
+
+void LayerCollection::reverse()
+{
+    reorder([this] { return tk::vector<tk::shared_ptr<Layer>>(m_collection.rbegin(), m_collection.rend()); },
+            "Reverse Layers");
 }
 
 void LayerCollection::sort(std::function<bool(tk::shared_ptr<Layer>, tk::shared_ptr<Layer>)> compare)
 {
-    // std::sort(m_collection.begin(), m_collection.end(), compare);
-    for (int i = 0; i < m_collection.size(); i++)
-    {
-        for (int j = i + 1; j < m_collection.size(); j++)
-        {
-            if (compare(m_collection[i], m_collection[j]))
-            {
-                LayerSuite().ReorderLayer(m_collection[i]->getLayer(), j);
-                std::swap(m_collection[i], m_collection[j]);
-            }
-        }
-    }
+    // Sorting runs in the same main-thread task as the reorders, so comparators that query AE run inline.
+    reorder(
+        [this, &compare] {
+            tk::vector<tk::shared_ptr<Layer>> target = m_collection;
+            std::stable_sort(target.begin(), target.end(), compare);
+            return target;
+        },
+        "Sort Layers");
 }
 
 void LayerCollection::createCollection()
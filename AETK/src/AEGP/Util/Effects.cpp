@@ -1,56 +1,169 @@
 #include <AETK/AEGP/Layers.hpp>
 #include <AETK/AEGP/Util/Effects.hpp>
 #include <AETK/AEGP/Util/Properties.hpp>
+#include <AETK/AEGP/Util/Transaction.hpp>
 
-tk::shared_ptr<Effect> Effect::apply(tk::shared_ptr<Layer> layer, const std::string &matchName)
+std::shared_ptr<const EffectRegistry::Table> EffectRegistry::buildTable()
 {
-    try
-    {
+    return ae::batch([] {
+               auto table = std::make_shared<Table>();
+               auto *effectSuite = SuiteManager::GetInstance().GetSuiteHandler().EffectSuite4();
+
+               A_long numEffects = 0;
+               AE_CHECK(effectSuite->AEGP_GetNumInstalledEffects(&numEffects));
+               table->effects.reserve(numEffects);
 
-        AEGP_InstalledEffectKey currentKey = 0; // Assuming 0 is a valid initial key or indicates 'start'.
-        A_long numEffects = EffectSuite().getNumInstalledEffects();
+               AEGP_InstalledEffectKey key = AEGP_InstalledEffectKey_NONE;
+               for (A_long i = 0; i < numEffects; ++i)
+               {
+                   AE_CHECK(effectSuite->AEGP_GetNextInstalledEffect(key, &key));
+
+                   A_char matchName[AEGP_MAX_EFFECT_MATCH_NAME_SIZE];
+                   A_char name[AEGP_MAX_EFFECT_NAME_SIZE];
+                   A_char category[AEGP_MAX_EFFECT_CATEGORY_NAME_SIZE];
+                   AE_CHECK(effectSuite->AEGP_GetEffectMatchName(key, matchName));
+                   AE_CHECK(effectSuite->AEGP_GetEffectName(key, name));
+                   AE_CHECK(effectSuite->AEGP_GetEffectCategory(key, category));
+
+                   table->byMatchName.emplace(matchName, table->effects.size());
+                   table->byKey.emplace(key, table->effects.size());
+                   table->effects.push_back({key, matchName, name, category});
+               }
+               return std::shared_ptr<const Table>(std::move(table));
+           })
+        .get();
+}
 
-        for (A_long i = 0; i < numEffects; ++i)
+std::shared_ptr<const EffectRegistry::Table> EffectRegistry::table()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_table)
         {
-            std::string currentMatchName = EffectSuite().getEffectMatchName(currentKey);
-            if (currentMatchName == matchName)
-            {
-                // Match found, apply effect.
-                EffectRefPtr effectRef = EffectSuite().applyEffect(layer->getLayer(), currentKey);
-
-                return tk::make_shared<Effect>(effectRef);
-            }
-            currentKey = EffectSuite().getNextInstalledEffect(currentKey);
+            return m_table;
         }
+    }
+    // Built outside the lock: building waits on the main thread, which may itself be looking up an effect.
+    auto built = buildTable();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_table)
+    {
+        m_table = std::move(built);
+    }
+    return m_table;
+}
 
-        return nullptr;
+std::optional<AEGP_InstalledEffectKey> EffectRegistry::keyFor(const std::string &matchName)
+{
+    auto current = table();
+    auto it = current->byMatchName.find(matchName);
+    if (it == current->byMatchName.end())
+    {
+        return std::nullopt;
     }
-    catch (const AEException &e)
+    return current->effects[it->second].key;
+}
+
+std::optional<EffectRegistry::Info> EffectRegistry::find(const std::string &matchName)
+{
+    auto current = table();
+    auto it = current->byMatchName.find(matchName);
+    if (it == current->byMatchName.end())
     {
-        throw e;
+        return std::nullopt;
     }
+    return current->effects[it->second];
 }
 
-std::string Effect::name()
+std::optional<EffectRegistry::Info> EffectRegistry::find(AEGP_InstalledEffectKey key)
 {
-    try
+    auto current = table();
+    auto it = current->byKey.find(key);
+    if (it == current->byKey.end())
     {
-        return EffectSuite().getEffectName(m_key);
+        return std::nullopt;
     }
-    catch (const AEException &e)
+    return current->effects[it->second];
+}
+
+tk::vector<EffectRegistry::Info> EffectRegistry::effects()
+{
+    return table()->effects;
+}
+
+std::size_t EffectRegistry::size()
+{
+    return table()->effects.size();
+}
+
+void EffectRegistry::refresh()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.reset();
+}
+
+tk::shared_ptr<Effect> Effect::apply(tk::shared_ptr<Layer> layer, const std::string &matchName)
+{
+    auto key = EffectRegistry::GetInstance().keyFor(matchName);
+    if (!key)
     {
-        throw e;
+        return nullptr;
     }
+    EffectRefPtr effectRef = EffectSuite().applyEffect(layer->getLayer(), *key);
+    PropertyCache::invalidateAll(); // the layer's effect group has a new child
+    return tk::make_shared<Effect>(effectRef, *key);
+}
+
+tk::vector<tk::shared_ptr<Effect>> Effect::applyToLayers(const tk::vector<tk::shared_ptr<Layer>> &layers,
+                                                         const std::string &matchName, const std::string &undoName)
+{
+    auto key = EffectRegistry::GetInstance().keyFor(matchName);
+    if (!key || layers.empty())
+    {
+        return {};
+    }
+    auto effects = ae::batch(
+                       [&layers, installedKey = *key] {
+                           tk::vector<tk::shared_ptr<Effect>> applied;
+                           applied.reserve(layers.size());
+                           for (const auto &layer : layers)
+                           {
+                               EffectRefPtr effectRef = EffectSuite().applyEffect(layer->getLayer(), installedKey);
+                               applied.push_back(tk::make_shared<Effect>(effectRef, installedKey));
+                           }
+                           return applied;
+                       },
+                       undoName)
+                       .get();
+    PropertyCache::invalidateAll(); // every layer's effect group has a new child
+    return effects;
+}
+
+AEGP_InstalledEffectKey Effect::key()
+{
+    if (m_key == AEGP_InstalledEffectKey_NONE)
+    {
+        m_key = EffectSuite().getInstalledKeyFromLayerEffect(m_effect);
+    }
+    return m_key;
+}
+
+std::string Effect::name()
+{
+    auto info = EffectRegistry::GetInstance().find(key());
+    return info ? info->name : EffectSuite().getEffectName(key());
 }
 
 std::string Effect::matchName()
 {
-    return EffectSuite().getEffectMatchName(m_key);
+    auto info = EffectRegistry::GetInstance().find(key());
+    return info ? info->matchName : EffectSuite().getEffectMatchName(key());
 }
 
 std::string Effect::category()
 {
-    return EffectSuite().getEffectCategory(m_key);
+    auto info = EffectRegistry::GetInstance().find(key());
+    return info ? info->category : EffectSuite().getEffectCategory(key());
 }
 
 tk::shared_ptr<BaseProperty> Effect::param(int index)
@@ -80,5 +193,6 @@ void Effect::callGeneric(double time, PF_Cmd cmd, void *extra) {}
 tk::shared_ptr<Effect> Effect::duplicate()
 {
     EffectRefPtr effectRef = EffectSuite().duplicateEffect(m_effect);
-    return tk::make_shared<Effect>(effectRef);
+    PropertyCache::invalidateAll(); // effects after this one have moved down
+    return tk::make_shared<Effect>(effectRef, m_key);
 }
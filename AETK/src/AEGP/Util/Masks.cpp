@@ -4,13 +4,21 @@
 tk::shared_ptr<BaseProperty> Mask::getProperty(MaskStream property)
 {
     auto stream = StreamSuite().GetNewMaskStream(m_mask, property);
-    return PropertyFactory::CreateProperty(stream);
+    auto maskProperty = PropertyFactory::CreateProperty(stream);
+    if (maskProperty)
+    {
+        maskProperty->inheritTimeBase(*this);
+    }
+    return maskProperty;
 }
 
 tk::shared_ptr<Mask> Mask::getMask(LayerPtr layer, A_long maskIndex)
 {
     auto maskref = MaskSuite().getLayerMaskByIndex(layer, maskIndex); 
-	return tk::make_shared<Mask>(maskref);
+	auto mask = tk::make_shared<Mask>(maskref);
+    mask->setTimeBaseSource(
+        std::make_shared<ae::LazyTimeBase>([layer] { return ae::TimeBase::fromLayer(layer->get()); }));
+    return mask;
 }
 
 bool Mask::invert()
@@ -5,7 +5,7 @@ std::string BaseProperty::getName() const
 {
     try
     {
-        return StreamSuite().GetStreamName(m_property, TRUE);
+        return StreamSuite().GetStreamName(getStream(), TRUE);
     }
     catch (const AEException &e)
     {
@@ -16,14 +16,15 @@ std::string BaseProperty::getName() const
 void BaseProperty::setName(const std::string &name)
 {
 
-    DynamicStreamSuite().SetStreamName(m_property, name);
+    DynamicStreamSuite().SetStreamName(getStream(), name);
 }
 
 std::shared_ptr<BaseProperty> BaseProperty::duplicate()
 {
 
-    auto newStream = DynamicStreamSuite().DuplicateStream(m_property);
-    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(m_property, newStream);
+    auto newStream = DynamicStreamSuite().DuplicateStream(getStream());
+    PropertyCache::invalidateAll(); // sibling indexes have shifted
+    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(getStream(), newStream);
     return PropertyFactory::CreateProperty(stream);
 }
 
@@ -31,7 +32,7 @@ std::string BaseProperty::matchName() const
 {
     try
     {
-        return DynamicStreamSuite().GetMatchname(m_property);
+        return DynamicStreamSuite().GetMatchname(getStream());
     }
     catch (const AEException &e)
     {
@@ -41,36 +42,37 @@ std::string BaseProperty::matchName() const
 
 void BaseProperty::reOrder(int index)
 {
-    DynamicStreamSuite().ReorderStream(m_property, index);
+    DynamicStreamSuite().ReorderStream(getStream(), index);
+    PropertyCache::invalidateAll(); // sibling indexes have shifted
 }
 
 std::shared_ptr<BaseProperty> BaseProperty::getProperty(const std::string &name) const
 {
 
-    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(m_property, name);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(getStream(), name);
     return PropertyFactory::CreateProperty(stream);
 }
 
 std::shared_ptr<BaseProperty> BaseProperty::getPropertyByIndex(int index) const
 {
 
-    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(m_property, index);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(getStream(), index);
     return PropertyFactory::CreateProperty(stream);
 }
 
 void BaseProperty::addProperty(const std::string &name) const
 {
 
-    if (DynamicStreamSuite().CanAddStream(m_property, name))
+    if (DynamicStreamSuite().CanAddStream(getStream(), name))
     {
-        DynamicStreamSuite().AddStream(m_property, name);
+        DynamicStreamSuite().AddStream(getStream(), name);
     }
 }
 
 void BaseProperty::removeProperty(const std::string &name) const
 {
 
-    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(m_property, name);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(getStream(), name);
     if (stream)
     {
         DynamicStreamSuite().DeleteStream(stream);
@@ -80,7 +82,7 @@ void BaseProperty::removeProperty(const std::string &name) const
 void BaseProperty::removeProperty(int index) const
 {
 
-    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(m_property, index);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(getStream(), index);
     if (stream)
     {
         DynamicStreamSuite().DeleteStream(stream);
@@ -89,28 +91,28 @@ void BaseProperty::removeProperty(int index) const
 
 int BaseProperty::numKeys()
 {
-    int numKeys = KeyframeSuite().GetStreamNumKFs(m_property);
+    int numKeys = KeyframeSuite().GetStreamNumKFs(getStream());
     return numKeys;
 }
 
 KeyFrame BaseProperty::getKeyframe(int index) // Gets the Key at the given index.
 {
-    auto keyNum = KeyframeSuite().GetStreamNumKFs(m_property);
+    auto keyNum = KeyframeSuite().GetStreamNumKFs(getStream());
     if (index >= keyNum)
     {
         throw std::out_of_range("Keyframe index out of range");
     }
     auto keyIndex = index;
-    auto time = KeyframeSuite().GetKeyframeTime(m_property, keyIndex, LTimeMode::CompTime).toSeconds();
-    auto value = KeyframeSuite().GetNewKeyframeValue(m_property, keyIndex);
-    auto flags = KeyframeSuite().GetKeyframeFlags(m_property, keyIndex);
-    auto interp = KeyframeSuite().GetKeyframeInterpolation(m_property, keyIndex);
+    auto time = KeyframeSuite().GetKeyframeTime(getStream(), keyIndex, LTimeMode::CompTime).toSeconds();
+    auto value = KeyframeSuite().GetNewKeyframeValue(getStream(), keyIndex);
+    auto flags = KeyframeSuite().GetKeyframeFlags(getStream(), keyIndex);
+    auto interp = KeyframeSuite().GetKeyframeInterpolation(getStream(), keyIndex);
     auto inInterp = std::get<0>(interp);
     auto outInterp = std::get<1>(interp);
-    auto tangents = KeyframeSuite().GetNewKeyframeSpatialTangents(m_property, keyIndex);
+    auto tangents = KeyframeSuite().GetNewKeyframeSpatialTangents(getStream(), keyIndex);
     auto inTan = std::get<0>(tangents);
     auto outTan = std::get<1>(tangents);
-    auto ease = KeyframeSuite().GetKeyframeTemporalEase(m_property, keyIndex, 0);
+    auto ease = KeyframeSuite().GetKeyframeTemporalEase(getStream(), keyIndex, 0);
     auto inEase = std::get<0>(ease);
     auto outEase = std::get<1>(ease);
     KeyFrame config(time);
@@ -126,7 +128,7 @@ KeyFrame BaseProperty::getKeyframe(int index) // Gets the Key at the given index
 
 inline tk::vector<KeyFrame> BaseProperty::getKeyframes() // Gets all the keys
 {
-    auto keyNum = KeyframeSuite().GetStreamNumKFs(m_property);
+    auto keyNum = KeyframeSuite().GetStreamNumKFs(getStream());
     tk::vector<KeyFrame> keyframes;
     for (int i = 0; i < keyNum; i++)
     {
@@ -140,10 +142,10 @@ inline KeyFrame BaseProperty::getNearestKeyframe(double time) // Gets the neares
     double nearestTimeDifference = 1e308; // Set to a large number
     int nearestKeyIndex = -1;
 
-    int keyNum = KeyframeSuite().GetStreamNumKFs(m_property);
+    int keyNum = KeyframeSuite().GetStreamNumKFs(getStream());
     for (int i = 0; i < keyNum; i++)
     {
-        auto keyTime = KeyframeSuite().GetKeyframeTime(m_property, i, LTimeMode::CompTime).toSeconds();
+        auto keyTime = KeyframeSuite().GetKeyframeTime(getStream(), i, LTimeMode::CompTime).toSeconds();
         double timeDifference = std::abs(keyTime - time);
 
         if (timeDifference < nearestTimeDifference)
@@ -165,8 +167,13 @@ inline KeyFrame BaseProperty::getNearestKeyframe(double time) // Gets the neares
 
 inline void BaseProperty::addKey(const KeyFrame &keyframe) // Adds Keyframe to the property
 {
-    auto akH = KeyframeSuite().StartAddKeyframes(m_property);
-    auto keyIndex = KeyframeSuite().AddKeyframes(akH, LTimeMode::CompTime, SecondsToTime(keyframe.time));
+    addKey(keyframe, timeBase());
+}
+
+inline void BaseProperty::addKey(const KeyFrame &keyframe, const ae::TimeBase &base)
+{
+    auto akH = KeyframeSuite().StartAddKeyframes(getStream());
+    auto keyIndex = KeyframeSuite().AddKeyframes(akH, LTimeMode::CompTime, base.secondsToTime(keyframe.time));
     KeyframeSuite().SetAddKeyframe(akH, keyIndex, makeStreamValue2Ptr(convertToAEValue(keyframe.value)));
     //converttoAEValue(keyframe.value) make this accept streamrefptr as well (for binding)
     //makeStreaValue2otr take streamRefptr as arg, then std::variant, then return streamValue2Ptr
@@ -204,10 +211,15 @@ inline void BaseProperty::addKey(const KeyFrame &keyframe) // Adds Keyframe to t
 
 inline void BaseProperty::addKeys(const tk::vector<KeyFrame> &keyframes) // Adds multiple keyframes to the property
 {
-    auto akH = KeyframeSuite().StartAddKeyframes(m_property);
+    addKeys(keyframes, timeBase());
+}
+
+inline void BaseProperty::addKeys(const tk::vector<KeyFrame> &keyframes, const ae::TimeBase &base)
+{
+    auto akH = KeyframeSuite().StartAddKeyframes(getStream());
     for (const auto &keyframe : keyframes)
     {
-        auto keyIndex = KeyframeSuite().AddKeyframes(akH, LTimeMode::CompTime, SecondsToTime(keyframe.time));
+        auto keyIndex = KeyframeSuite().AddKeyframes(akH, LTimeMode::CompTime, base.secondsToTime(keyframe.time));
         KeyframeSuite().SetAddKeyframe(akH, keyIndex, makeStreamValue2Ptr(convertToAEValue(keyframe.value)));
         setKeyFlags(keyIndex, keyframe.flags);
 
@@ -246,33 +258,33 @@ inline void BaseProperty::setKeyFlags(AEGP_KeyframeIndex keyIndex, tk::vector<Ke
 {
     for (auto flag : flags)
     {
-        KeyframeSuite().SetKeyframeFlag(m_property, keyIndex, flag, true);
+        KeyframeSuite().SetKeyframeFlag(getStream(), keyIndex, flag, true);
     }
 }
 
 inline void BaseProperty::setKeyInterpolation(AEGP_KeyframeIndex keyIndex, KeyInterp inInterp, KeyInterp outInterp)
 {
-    KeyframeSuite().SetKeyframeInterpolation(m_property, keyIndex, inInterp, outInterp);
+    KeyframeSuite().SetKeyframeInterpolation(getStream(), keyIndex, inInterp, outInterp);
 }
 
 inline void BaseProperty::setKeyTemporalEase(AEGP_KeyframeIndex keyIndex, A_long dimension, KeyframeEase inEase,
                                              KeyframeEase outEase)
 {
     KeyframeSuite().SetKeyframeTemporalEase(
-        m_property, keyIndex, KeyframeSuite().GetStreamTemporalDimensionality(m_property), inEase, outEase);
+        getStream(), keyIndex, KeyframeSuite().GetStreamTemporalDimensionality(getStream()), inEase, outEase);
 }
 
 inline void BaseProperty::setKeySpatialTangents(AEGP_KeyframeIndex keyIndex, AEGP_StreamValue2 inTan,
                                                 AEGP_StreamValue2 outTan)
 {
-    KeyframeSuite().SetKeyframeSpatialTangents(m_property, keyIndex, makeStreamValue2Ptr(inTan),
+    KeyframeSuite().SetKeyframeSpatialTangents(getStream(), keyIndex, makeStreamValue2Ptr(inTan),
                                                makeStreamValue2Ptr(outTan));
 }
 
 inline AEGP_StreamValue2 BaseProperty::convertToAEValue(const KeyFrame::TangentValue &value)
 {
     AEGP_StreamValue2 aeValue;
-    aeValue.streamH = *m_property;
+    aeValue.streamH = *getStream();
     std::visit(overloaded{
                    [&](double val) { aeValue.val.one_d = val; }, [&](TwoDVal val) { aeValue.val.two_d = val.toAEGP(); },
                    [&](ThreeDVal val) { aeValue.val.three_d = val.toAEGP(); },
@@ -286,7 +298,7 @@ inline AEGP_StreamValue2 BaseProperty::convertToAEValue(const KeyFrame::TangentV
 
 KeyFrame::TangentValue BaseProperty::convertToTangentValue(AEGP_StreamValue2 value)
 {
-    switch (StreamSuite().GetStreamType(m_property))
+    switch (StreamSuite().GetStreamType(getStream()))
     {
     case StreamType::OneD:
         return value.val.one_d;
@@ -305,7 +317,7 @@ KeyFrame::TangentValue BaseProperty::convertToTangentValue(AEGP_StreamValue2 val
 
 double OneDProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     double value = val->get().val.one_d;
     return value;
 }
@@ -315,12 +327,12 @@ void OneDProperty::setValue(double value)
 
     AEGP_StreamValue2 val;
     val.val.one_d = value;
-    StreamSuite().SetStreamValue(m_property, makeStreamValue2Ptr(val));
+    StreamSuite().SetStreamValue(getStream(), makeStreamValue2Ptr(val));
 }
 
 TwoDVal TwoDProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     TwoDVal value(val->get().val.two_d);
     return value;
 }
@@ -329,12 +341,12 @@ void TwoDProperty::setValue(TwoDVal value)
 {
     AEGP_StreamValue2 val;
     val.val.two_d = value.toAEGP();
-    StreamSuite().SetStreamValue(m_property, makeStreamValue2Ptr(val));
+    StreamSuite().SetStreamValue(getStream(), makeStreamValue2Ptr(val));
 }
 
 ThreeDVal ThreeDProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     ThreeDVal value(val->get().val.three_d);
     return value;
 }
@@ -343,13 +355,13 @@ void ThreeDProperty::setValue(ThreeDVal value)
 {
     AEGP_StreamValue2 val;
     val.val.three_d = value.toAEGP();
-    StreamSuite().SetStreamValue(m_property, makeStreamValue2Ptr(val));
+    StreamSuite().SetStreamValue(getStream(), makeStreamValue2Ptr(val));
 }
 
 ColorVal ColorProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
 
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     ColorVal value(val->get().val.color);
     return value;
 }
@@ -358,70 +370,83 @@ void ColorProperty::setValue(ColorVal value)
 {
     AEGP_StreamValue2 val;
     val.val.color = value.toAEGP();
-    StreamSuite().SetStreamValue(m_property, makeStreamValue2Ptr(val));
+    StreamSuite().SetStreamValue(getStream(), makeStreamValue2Ptr(val));
 }
 
 std::shared_ptr<Marker> MarkerProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     return std::make_shared<Marker>(makeMarkerValPtr(val->get().val.markerP));
 }
 
 std::shared_ptr<Marker> MarkerProperty::addMarker(double time)
 {
-    auto idx = KeyframeSuite().InsertKeyframe(m_property, LTimeMode::CompTime, SecondsToTime(time));
+    auto idx = KeyframeSuite().InsertKeyframe(getStream(), LTimeMode::CompTime, timeBase().secondsToTime(time));
     MarkerValPtr mrk = MarkerSuite().getNewMarker();
     AEGP_StreamValue2 val;
-    val.streamH = *m_property;
+    val.streamH = *getStream();
     val.val.markerP = *mrk;
-    KeyframeSuite().SetKeyframeValue(m_property, idx, makeStreamValue2Ptr(val));
+    KeyframeSuite().SetKeyframeValue(getStream(), idx, makeStreamValue2Ptr(val));
     return std::make_shared<Marker>(mrk);
 }
 
 int LayerIDProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     int value = val->get().val.layer_id;
     return value;
 }
 
 int MaskIDProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     int value = val->get().val.mask_id;
     return value;
 }
 
 std::shared_ptr<MaskOutline> MaskOutlineProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
     return std::make_shared<MaskOutline>(makeMaskOutlineValPtr(val->get().val.mask));
 }
 
 std::shared_ptr<TextDocument> TextDocumentProperty::getValue(LTimeMode timeMode, double time, bool preExpression) const
 {
-    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(m_property, timeMode, SecondsToTime(time), preExpression);
+    StreamValue2Ptr val = StreamSuite().GetNewStreamValue(getStream(), timeMode, timeBase().secondsToTime(time), preExpression);
 
     return std::make_shared<TextDocument>(makeTextDocumentPtr(val->get().val.text_documentH));
 }
 
 int PropertyGroup::getNumProperties() const
 {
-    return DynamicStreamSuite().GetNumStreamsInGroup(m_property);
+    return DynamicStreamSuite().GetNumStreamsInGroup(getStream());
 }
 
 std::shared_ptr<BaseProperty> PropertyGroup::getProperty(const std::string &name) const
 {
-    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(m_property, name);
-    return PropertyFactory::CreateProperty(stream);
+    return m_cache.byName(name, [this, &name] {
+        auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(getStream(), name);
+        auto property = PropertyFactory::CreateProperty(stream);
+        if (property)
+        {
+            property->inheritTimeBase(*this);
+        }
+        return property;
+    });
 }
 
 std::shared_ptr<BaseProperty> PropertyGroup::getPropertyByIndex(int index) const
 {
     try
     {
-        auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(m_property, index);
-        return PropertyFactory::CreateProperty(stream);
+        // Not cached: indexes shift when streams are added, removed or reordered in the UI.
+        auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(getStream(), index);
+        auto property = PropertyFactory::CreateProperty(stream);
+        if (property)
+        {
+            property->inheritTimeBase(*this);
+        }
+        return property;
     }
     catch (const AEException &e)
     {
@@ -431,26 +456,29 @@ std::shared_ptr<BaseProperty> PropertyGroup::getPropertyByIndex(int index) const
 
 void PropertyGroup::addProperty(const std::string &name) const
 {
-    if (DynamicStreamSuite().CanAddStream(m_property, name))
+    if (DynamicStreamSuite().CanAddStream(getStream(), name))
     {
-        DynamicStreamSuite().AddStream(m_property, name);
+        DynamicStreamSuite().AddStream(getStream(), name);
+        m_cache.clear();
     }
 }
 
 void PropertyGroup::removeProperty(const std::string &name) const
 {
-    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(m_property, name);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByMatchname(getStream(), name);
     if (stream)
     {
         DynamicStreamSuite().DeleteStream(stream);
+        m_cache.clear();
     }
 }
 
 void PropertyGroup::removeProperty(int index) const
 {
-    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(m_property, index);
+    auto stream = DynamicStreamSuite().GetNewStreamRefByIndex(getStream(), index);
     if (stream)
     {
         DynamicStreamSuite().DeleteStream(stream);
+        m_cache.clear();
     }
 }
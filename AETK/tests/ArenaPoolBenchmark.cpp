@@ -0,0 +1,225 @@
+/*****************************************************************/ /**
+                                                                     * \file   ArenaPoolBenchmark.cpp
+                                                                     * \brief  Times allocation churn through
+                                                                     *AEGPCustomAllocator against std::allocator.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+// Standalone: AE's memory suite is replaced by a stub that hands out malloc'd handles, served through a fake
+// SPBasicSuite, so the allocators run their real host-call paths without After Effects. Build with optimizations
+// from the repository root together with the SDK's suite handler, then run it; it returns non-zero if a block is
+// overwritten while live.
+//
+//   cl /std:c++17 /O2 /EHsc /I. /IHeaders /IHeaders\SP /IUtil /IHeaders\adobesdk ^
+//      AETK\tests\ArenaPoolBenchmark.cpp Util\AEGP_SuiteHandler.cpp Util\MissingSuiteError.cpp
+//
+// Each thread keeps 1024 slots and, 2^21 times, frees a random occupied slot or fills an empty one with a block of
+// 16 to 512 bytes. Three allocators are compared: std::allocator, AEGPCustomAllocator (ArenaPool) and the
+// allocator it replaced, reproduced below, which made one memory handle per allocation and tracked it in a
+// per-instance map. The stub's handles cost one malloc, far less than AE's, so the gap to the old allocator is a
+// lower bound.
+
+#include "AETK/AEGP/Core/Allocator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+std::atomic<int> failures{0};
+
+const std::size_t Slots = 1024;
+const std::size_t OpsPerThread = std::size_t(1) << 21;
+
+// Memory handles are a malloc'd header followed by the block.
+struct StubHandle
+{
+    AEGP_MemSize size;
+    alignas(16) unsigned char data[1];
+};
+
+A_Err StubNew(AEGP_PluginID, const A_char *, AEGP_MemSize size, AEGP_MemFlag flags, AEGP_MemHandle *handle)
+{
+    auto *stub = static_cast<StubHandle *>(std::malloc(offsetof(StubHandle, data) + size));
+    if (!stub)
+    {
+        return A_Err_ALLOC;
+    }
+    stub->size = size;
+    if (flags & AEGP_MemFlag_CLEAR)
+    {
+        std::memset(stub->data, 0, size);
+    }
+    *handle = reinterpret_cast<AEGP_MemHandle>(stub);
+    return A_Err_NONE;
+}
+
+A_Err StubFree(AEGP_MemHandle handle)
+{
+    std::free(handle);
+    return A_Err_NONE;
+}
+
+A_Err StubLock(AEGP_MemHandle handle, void **ptr)
+{
+    *ptr = reinterpret_cast<StubHandle *>(handle)->data;
+    return A_Err_NONE;
+}
+
+A_Err StubUnlock(AEGP_MemHandle)
+{
+    return A_Err_NONE;
+}
+
+AEGP_MemorySuite1 StubMemorySuite = {&StubNew, &StubFree, &StubLock, &StubUnlock};
+
+SPErr StubAcquire(const char *name, int32, const void **suite)
+{
+    if (std::strcmp(name, kAEGPMemorySuite) != 0)
+    {
+        return kSPSuiteNotFoundError;
+    }
+    *suite = &StubMemorySuite;
+    return kSPNoError;
+}
+
+SPErr StubRelease(const char *, int32)
+{
+    return kSPNoError;
+}
+
+SPBasicSuite StubBasicSuite = {&StubAcquire, &StubRelease};
+AEGP_PluginID StubPluginID = 1;
+
+// The allocator AEGPCustomAllocator used before ArenaPool: a memory handle per allocation, found again through a
+// map owned by the allocator instance.
+template <typename T> class HandleAllocator
+{
+  public:
+    using value_type = T;
+
+    T *allocate(std::size_t n)
+    {
+        auto *memorySuite = SuiteManager::GetInstance().GetSuiteHandler().MemorySuite1();
+        AEGP_MemHandle handle = nullptr;
+        const auto size = static_cast<AEGP_MemSize>(n * sizeof(T));
+        memorySuite->AEGP_NewMemHandle(StubPluginID, "Custom Allocator Memory", size, AEGP_MemFlag_CLEAR, &handle);
+        void *ptr = nullptr;
+        memorySuite->AEGP_LockMemHandle(handle, &ptr);
+        m_handles[static_cast<T *>(ptr)] = handle;
+        return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        auto it = m_handles.find(p);
+        if (it != m_handles.end())
+        {
+            auto *memorySuite = SuiteManager::GetInstance().GetSuiteHandler().MemorySuite1();
+            memorySuite->AEGP_UnlockMemHandle(it->second);
+            memorySuite->AEGP_FreeMemHandle(it->second);
+            m_handles.erase(it);
+        }
+    }
+
+  private:
+    std::unordered_map<T *, AEGP_MemHandle> m_handles;
+};
+
+// Every live block is filled with its slot's tag, and checked when it is freed.
+template <typename Allocator> void Churn(unsigned seed)
+{
+    Allocator allocator;
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<std::size_t> slotOf(0, Slots - 1), sizeOf(16, 512);
+    std::vector<std::pair<unsigned char *, std::size_t>> slots(Slots, {nullptr, 0});
+    int errors = 0;
+
+    auto release = [&](std::size_t slot) {
+        auto &block = slots[slot];
+        for (std::size_t i = 0; i < block.second; i += 16)
+        {
+            errors += block.first[i] != static_cast<unsigned char>(slot);
+        }
+        allocator.deallocate(block.first, block.second);
+        block = {nullptr, 0};
+    };
+
+    for (std::size_t op = 0; op < OpsPerThread; ++op)
+    {
+        const std::size_t slot = slotOf(random);
+        if (slots[slot].first)
+        {
+            release(slot);
+        }
+        else
+        {
+            const std::size_t size = sizeOf(random);
+            unsigned char *block = allocator.allocate(size);
+            std::memset(block, static_cast<unsigned char>(slot), size);
+            slots[slot] = {block, size};
+        }
+    }
+    for (std::size_t slot = 0; slot < Slots; ++slot)
+    {
+        if (slots[slot].first)
+        {
+            release(slot);
+        }
+    }
+    failures += errors;
+}
+
+template <typename Allocator> double Time(unsigned threads)
+{
+    double best = 1e9;
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(&Churn<Allocator>, pass * 100 + t);
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        best = (std::min)(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return threads * OpsPerThread / best;
+}
+} // namespace
+
+int main()
+{
+    SuiteManager::GetInstance().InitializeSuiteHandler(&StubBasicSuite);
+    SuiteManager::GetInstance().SetPluginID(&StubPluginID);
+
+    std::printf("threads  std::allocator    ArenaPool         handle per block  vs std  vs handles\n");
+    for (unsigned threads : {1u, 2u, 4u, 8u})
+    {
+        const double standard = Time<std::allocator<unsigned char>>(threads);
+        const double arena = Time<AEGPCustomAllocator<unsigned char>>(threads);
+        const double handles = Time<HandleAllocator<unsigned char>>(threads);
+        std::printf("%7u  %6.1f Mops/s    %6.1f Mops/s    %6.1f Mops/s     %5.2fx  %5.2fx\n", threads, standard / 1e6,
+                    arena / 1e6, handles / 1e6, arena / standard, arena / handles);
+    }
+    std::printf("ArenaPool reserved %zu chunk(s)\n", ae::ArenaPool::GetInstance().chunkCount());
+    if (failures)
+    {
+        std::printf("%d block(s) were overwritten while live\n", failures.load());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*****************************************************************/ /**
+                                                                     * \file   KeyframeEvaluatorTest.cpp
+                                                                     * \brief  Checks KeyframeEvaluator against
+                                                                     *reference curves.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+// Standalone: the evaluator makes no host calls, so this builds and runs without After Effects. It prints each
+// failure and returns non-zero on any. From the repository root:
+//
+//   cl /std:c++17 /EHsc /I. /IHeaders /IHeaders\SP /IUtil /IHeaders\adobesdk AETK\tests\KeyframeEvaluatorTest.cpp
+//
+// The references are closed forms, or brute force for arc length. With both influences at one third, the ease
+// bezier's x(u) is u, so the eased value is the plain cubic in u.
+
+#include "AETK/AEGP/Util/KeyframeEvaluator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+int failures = 0;
+
+void Expect(const char *name, double actual, double expected, double tolerance = 1e-6)
+{
+    if (!(std::abs(actual - expected) <= tolerance))
+    {
+        std::printf("FAIL %s: got %.9g, expected %.9g\n", name, actual, expected);
+        ++failures;
+    }
+}
+
+struct Key
+{
+    double seconds;
+    double value[2];
+    KeyInterp in, out;
+    AEGP_KeyframeEase easeIn, easeOut;
+    double inTangent[2], outTangent[2];
+};
+
+const AEGP_KeyframeEase NoEase = {0.0, 100.0 / 3.0};
+
+ae::KeyframeTrack MakeTrack(StreamType type, const std::vector<Key> &keys)
+{
+    ae::KeyframeTrack track;
+    track.reset(type, 1);
+    for (const Key &key : keys)
+    {
+        track.times.push_back(A_Time{static_cast<A_long>(std::llround(key.seconds * 600)), 600});
+        for (int d = 0; d < track.dimensions; ++d)
+        {
+            track.values[d].push_back(key.value[d]);
+            if (track.spatial)
+            {
+                track.inTangents[d].push_back(key.inTangent[d]);
+                track.outTangents[d].push_back(key.outTangent[d]);
+            }
+        }
+        track.interp.push_back(ae::KeyframeTrack::packInterp(key.in, key.out));
+        track.flags.push_back(0);
+        track.easeIn[0].push_back(key.easeIn);
+        track.easeOut[0].push_back(key.easeOut);
+    }
+    return track;
+}
+
+void TestHold()
+{
+    ae::KeyframeEvaluator evaluator(MakeTrack(StreamType::OneD, {{0.0, {10}, KeyInterp::LINEAR, KeyInterp::HOLD},
+                                                                 {1.0, {20}, KeyInterp::HOLD, KeyInterp::LINEAR}}));
+    Expect("hold, before the first key", evaluator.evaluate(-1.0)[0], 10.0);
+    Expect("hold, inside the segment", evaluator.evaluate(0.999)[0], 10.0);
+    Expect("hold, at the second key", evaluator.evaluate(1.0)[0], 20.0);
+}
+
+void TestLinear()
+{
+    ae::KeyframeEvaluator evaluator(MakeTrack(StreamType::OneD, {{0.0, {0}, KeyInterp::LINEAR, KeyInterp::LINEAR},
+                                                                 {2.0, {100}, KeyInterp::LINEAR, KeyInterp::LINEAR},
+                                                                 {3.0, {40}, KeyInterp::LINEAR, KeyInterp::LINEAR}}));
+    Expect("linear, quarter", evaluator.evaluate(0.5)[0], 25.0);
+    Expect("linear, second segment", evaluator.evaluate(2.5)[0], 70.0);
+    Expect("linear, after the last key", evaluator.evaluate(10.0)[0], 40.0);
+
+    const double times[3] = {0.5, 1.0, 2.5};
+    double values[3] = {};
+    evaluator.evaluate(times, 3, values);
+    Expect("linear, batch", values[1], 50.0);
+    Expect("linear, batch end", values[2], 70.0);
+}
+
+// Easy ease (speed 0, influence 33.3%) on both sides: y = 3x^2 - 2x^3.
+void TestEased()
+{
+    ae::KeyframeEvaluator evaluator(
+        MakeTrack(StreamType::OneD, {{0.0, {0}, KeyInterp::BEZIER, KeyInterp::BEZIER, NoEase, NoEase},
+                                     {1.0, {80}, KeyInterp::BEZIER, KeyInterp::BEZIER, NoEase, NoEase}}));
+    for (double x : {0.1, 0.25, 0.5, 0.8})
+    {
+        Expect("eased 1D", evaluator.evaluate(x)[0], 80.0 * (3 * x * x - 2 * x * x * x));
+    }
+
+    // Leaving at 240/s: y1 = 240 * 1s / 3 = 80, so y = 3(1-u)^2 u * 80 + 3(1-u) u^2 * 80 + u^3 * 80.
+    const AEGP_KeyframeEase fast = {240.0, 100.0 / 3.0};
+    ae::KeyframeEvaluator launched(
+        MakeTrack(StreamType::OneD, {{0.0, {0}, KeyInterp::BEZIER, KeyInterp::BEZIER, NoEase, fast},
+                                     {1.0, {80}, KeyInterp::BEZIER, KeyInterp::BEZIER, NoEase, NoEase}}));
+    const double u = 0.3;
+    Expect("eased 1D with speed", launched.evaluate(u)[0],
+           3 * (1 - u) * (1 - u) * u * 80 + 3 * (1 - u) * u * u * 80 + u * u * u * 80);
+}
+
+// Linear out of the first key, eased into the second: the linear side is a handle at one third with the average
+// speed, so y = delta * (u + u^2 - u^3).
+void TestMixed()
+{
+    ae::KeyframeEvaluator evaluator(
+        MakeTrack(StreamType::OneD, {{0.0, {0}, KeyInterp::LINEAR, KeyInterp::LINEAR, NoEase, NoEase},
+                                     {2.0, {50}, KeyInterp::BEZIER, KeyInterp::BEZIER, NoEase, NoEase}}));
+    for (double x : {0.2, 0.5, 0.9})
+    {
+        Expect("mixed linear/bezier", evaluator.evaluate(2.0 * x)[0], 50.0 * (x + x * x - x * x * x));
+    }
+}
+
+void PathPoint(const double p[4][2], double u, double *out)
+{
+    const double v = 1.0 - u;
+    for (int d = 0; d < 2; ++d)
+    {
+        out[d] = v * v * v * p[0][d] + 3 * v * v * u * p[1][d] + 3 * v * u * u * p[2][d] + u * u * u * p[3][d];
+    }
+}
+
+// A symmetric arch from (0, 0) to (200, 0) with linear timing: constant speed along the path.
+void TestSpatial()
+{
+    ae::KeyframeEvaluator evaluator(MakeTrack(
+        StreamType::TwoD_SPATIAL,
+        {{0.0, {0, 0}, KeyInterp::LINEAR, KeyInterp::LINEAR, NoEase, NoEase, {0, 0}, {0, 100}},
+         {1.0, {200, 0}, KeyInterp::LINEAR, KeyInterp::LINEAR, NoEase, NoEase, {0, 100}, {0, 0}}}));
+    const double path[4][2] = {{0, 0}, {0, 100}, {200, 100}, {200, 0}};
+
+    auto middle = evaluator.evaluate(0.5);
+    Expect("spatial, middle x", middle[0], 100.0, 1e-3);
+    Expect("spatial, middle y", middle[1], 75.0, 1e-3);
+
+    // Brute-force arc length: the point a quarter of the way along the path.
+    const int steps = 200000;
+    std::vector<double> lengths(steps + 1, 0.0);
+    double previous[2], point[2];
+    PathPoint(path, 0.0, previous);
+    for (int i = 1; i <= steps; ++i)
+    {
+        PathPoint(path, static_cast<double>(i) / steps, point);
+        lengths[i] = lengths[i - 1] + std::hypot(point[0] - previous[0], point[1] - previous[1]);
+        previous[0] = point[0];
+        previous[1] = point[1];
+    }
+    const auto quarter = std::lower_bound(lengths.begin(), lengths.end(), lengths.back() / 4);
+    PathPoint(path, static_cast<double>(quarter - lengths.begin()) / steps, point);
+
+    auto value = evaluator.evaluate(0.25);
+    Expect("spatial, quarter x", value[0], point[0], 0.05);
+    Expect("spatial, quarter y", value[1], point[1], 0.05);
+}
+} // namespace
+
+int main()
+{
+    TestHold();
+    TestLinear();
+    TestEased();
+    TestMixed();
+    TestSpatial();
+    if (failures)
+    {
+        std::printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    std::printf("KeyframeEvaluator: all reference curves match\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*****************************************************************/ /**
+                                                                     * \file   PackedKeyframeBenchmark.cpp
+                                                                     * \brief  Compares the memory footprint of
+                                                                     *PackedKeyframe and KeyFrame.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+// Standalone: both keyframe types are plain data and make no host calls. Build with optimizations from the
+// repository root, then run it; it returns non-zero if a packed key does not round-trip to the same KeyFrame text.
+//
+//   cl /std:c++17 /O2 /EHsc /I. /IHeaders /IHeaders\SP /IUtil /IHeaders\adobesdk ^
+//      AETK\tests\PackedKeyframeBenchmark.cpp
+//
+// The track is 100000 bezier 2D spatial keys, each with a value, interpolation, one flag, both eases and tangents.
+// Allocations are counted by replacing the global operator new; the vectors are reserved up front, so any
+// allocation past the first is made by the keys themselves.
+
+#include "AETK/AEGP/Util/Keyframe.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace
+{
+int failures = 0;
+
+std::size_t allocations = 0;
+std::size_t allocatedBytes = 0;
+
+const std::size_t Keys = 100000;
+
+struct Usage
+{
+    std::size_t allocations;
+    std::size_t bytes;
+    double seconds;
+};
+
+template <typename Build> Usage Measure(Build &&build)
+{
+    const std::size_t startAllocations = allocations, startBytes = allocatedBytes;
+    const auto start = std::chrono::steady_clock::now();
+    build();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return {allocations - startAllocations, allocatedBytes - startBytes, seconds};
+}
+
+KeyFrame MakeKey(std::size_t i, std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> value(-500.0, 500.0);
+    KeyFrame key(i / 24.0);
+    key.setValue(TwoDVal(value(random), value(random)))
+        .setInterpolation(KeyInterp::BEZIER, KeyInterp::BEZIER)
+        .setFlag(KeyframeFlag::TEMPORAL_CONTINUOUS)
+        .setEaseIn(value(random), 33.3)
+        .setEaseOut(value(random), 66.6)
+        .setTangents(TwoDVal(value(random), value(random)), TwoDVal(value(random), value(random)));
+    return key;
+}
+
+void Report(const char *name, std::size_t size, const Usage &usage)
+{
+    std::printf("%-24s %4zu bytes  %7zu allocations  %6.2f MB  %7.2f ms\n", name, size, usage.allocations,
+                usage.bytes / 1e6, usage.seconds * 1000.0);
+}
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    allocatedBytes += size;
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    std::printf("sizeof: KeyFrame %zu, PackedKeyframe<1> %zu, <2> %zu, <3> %zu, <4> %zu\n", sizeof(KeyFrame),
+                sizeof(PackedKeyframe<1>), sizeof(PackedKeyframe<2>), sizeof(PackedKeyframe<3>),
+                sizeof(PackedKeyframe<4>));
+
+    std::mt19937 random(1);
+    std::vector<KeyFrame> keys;
+    const Usage keyFrames = Measure([&] {
+        keys.reserve(Keys);
+        for (std::size_t i = 0; i < Keys; ++i)
+        {
+            keys.push_back(MakeKey(i, random));
+        }
+    });
+
+    std::vector<PackedKeyframe<2>> packed;
+    const Usage packedKeys = Measure([&] {
+        packed.reserve(Keys);
+        for (const KeyFrame &key : keys)
+        {
+            packed.push_back(PackedKeyframe<2>::fromKeyFrame(key));
+        }
+    });
+
+    std::printf("%zu 2D spatial keys   sizeof   heap allocations  heap bytes      build\n", Keys);
+    Report("std::vector<KeyFrame>", sizeof(KeyFrame), keyFrames);
+    Report("std::vector<Packed<2>>", sizeof(PackedKeyframe<2>), packedKeys);
+    std::printf("packed keys use %.1fx less heap\n", static_cast<double>(keyFrames.bytes) / packedKeys.bytes);
+
+    // Packing must lose nothing KeyFrame::toString shows, directly or through a round trip.
+    for (std::size_t i = 0; i < Keys; i += 101)
+    {
+        const std::string expected = keys[i].toString();
+        failures += packed[i].toString() != expected || packed[i].toKeyFrame().toString() != expected;
+    }
+    if (failures)
+    {
+        std::printf("%d packed key(s) differ from their KeyFrame\n", failures);
+        return 1;
+    }
+    return 0;
+}
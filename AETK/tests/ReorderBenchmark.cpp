@@ -0,0 +1,106 @@
+/*****************************************************************/ /**
+                                                                     * \file   ReorderBenchmark.cpp
+                                                                     * \brief  Checks MinimalReorders' move counts
+                                                                     *and final orders, and times it.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+// Standalone: Reorder.hpp only needs the standard library. Build with optimizations from the repository root, then
+// run it; it returns non-zero if any plan leaves the wrong order or makes more than n - LIS moves.
+//
+//   cl /std:c++17 /O2 /EHsc /I. AETK\tests\ReorderBenchmark.cpp
+//
+// Each case reorders 0..n-1 into a random permutation, into the reverse order, and into a nearly sorted order (n / 20
+// random adjacent swaps). The move count is compared with n minus a quadratic longest-increasing-subsequence
+// reference, and the moves are replayed as AEGP_ReorderLayer would apply them (remove, then insert at the index).
+
+#include "AETK/AEGP/Util/Reorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+int failures = 0;
+
+// Length of the longest increasing subsequence of target ranks, by the O(n^2) recurrence.
+std::size_t ReferenceLis(const std::vector<int> &current, const std::vector<int> &target)
+{
+    std::vector<std::size_t> rank(target.size());
+    for (std::size_t i = 0; i < target.size(); ++i)
+    {
+        rank[target[i]] = i;
+    }
+    std::vector<std::size_t> best(current.size(), 1);
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i < current.size(); ++i)
+    {
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (rank[current[j]] < rank[current[i]])
+            {
+                best[i] = (std::max)(best[i], best[j] + 1);
+            }
+        }
+        longest = (std::max)(longest, best[i]);
+    }
+    return longest;
+}
+
+void Check(const char *name, const std::vector<int> &target)
+{
+    std::vector<int> current(target.size());
+    std::iota(current.begin(), current.end(), 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto moves = ae::MinimalReorders(current, target);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> order = current;
+    for (const auto &move : moves)
+    {
+        order.erase(std::find(order.begin(), order.end(), move.first));
+        order.insert(order.begin() + move.second, move.first);
+    }
+    const std::size_t expected = target.size() - ReferenceLis(current, target);
+    const bool ok = order == target && moves.size() == expected;
+    failures += !ok;
+    std::printf("%-14s n=%5zu  %5zu moves (n - LIS = %5zu)  %9.3f ms  %s\n", name, target.size(), moves.size(),
+                expected, seconds * 1000.0, ok ? "ok" : "FAIL");
+}
+} // namespace
+
+int main()
+{
+    std::mt19937 random(1);
+    for (std::size_t n : {0, 1, 2, 10, 100, 1000, 5000})
+    {
+        std::vector<int> sorted(n);
+        std::iota(sorted.begin(), sorted.end(), 0);
+
+        std::vector<int> shuffled = sorted;
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+        Check("random", shuffled);
+
+        Check("reversed", std::vector<int>(sorted.rbegin(), sorted.rend()));
+
+        std::vector<int> nearly = sorted;
+        for (std::size_t swap = 0; n > 1 && swap < (std::max)(n / 20, std::size_t(1)); ++swap)
+        {
+            const std::size_t at = random() % (n - 1);
+            std::swap(nearly[at], nearly[at + 1]);
+        }
+        Check("nearly sorted", nearly);
+    }
+    if (failures)
+    {
+        std::printf("%d case(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+/*****************************************************************/ /**
+                                                                     * \file   ScheduleOrExecuteBenchmark.cpp
+                                                                     * \brief  Times ScheduleOrExecute calls on the
+                                                                     *inline and queued paths.
+                                                                     *
+                                                                     * \author tjerf
+                                                                     * \date   April 2024
+                                                                     *********************************************************************/
+// Standalone: the utility suite is replaced by a stub whose AEGP_CauseIdleRoutinesToBeCalled wakes a thread that
+// plays AE's main thread and drains the TaskScheduler, the way Plugin's idle hook does. Build with optimizations
+// from the repository root together with the SDK's suite handler, then run it; it returns non-zero if a call runs
+// on the wrong thread, returns the wrong value or loses its exception.
+//
+//   cl /std:c++17 /O2 /EHsc /I. /IHeaders /IHeaders\SP /IUtil /IHeaders\adobesdk ^
+//      AETK\tests\ScheduleOrExecuteBenchmark.cpp Util\AEGP_SuiteHandler.cpp Util\MissingSuiteError.cpp
+//
+// TK_INTERNAL is defined so calls from other threads are queued, as in the plugin build. Three rates are reported:
+// calls made on the main thread (run inline), calls from worker threads that each wait for their result (one
+// queue round trip per call), and calls from a worker that queues 64 before waiting (queue throughput).
+
+#define TK_INTERNAL
+#include "AETK/AEGP/Util/TaskScheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::atomic<int> failures{0};
+
+// Set by AEGP_CauseIdleRoutinesToBeCalled; the main thread sleeps until it is.
+std::mutex idleMutex;
+std::condition_variable idleWake;
+bool idleRequested = false;
+
+A_Err StubCauseIdle()
+{
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idleRequested = true;
+    }
+    idleWake.notify_one();
+    return A_Err_NONE;
+}
+
+AEGP_UtilitySuite6 StubUtilitySuite{};
+
+SPErr StubAcquire(const char *name, int32, const void **suite)
+{
+    if (std::strcmp(name, kAEGPUtilitySuite) != 0)
+    {
+        return kSPSuiteNotFoundError;
+    }
+    *suite = &StubUtilitySuite;
+    return kSPNoError;
+}
+
+SPErr StubRelease(const char *, int32)
+{
+    return kSPNoError;
+}
+
+SPBasicSuite StubBasicSuite = {&StubAcquire, &StubRelease};
+
+// Only ever touched on the main thread, by inline and queued calls alike.
+long long mainCounter = 0;
+
+long long Increment()
+{
+    failures += !ae::IsMainThread();
+    return ++mainCounter;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double Inline(std::size_t calls)
+{
+    const long long before = mainCounter;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < calls; ++i)
+    {
+        ae::ScheduleOrExecute(&Increment).get();
+    }
+    const double seconds = Seconds(start);
+    failures += mainCounter - before != static_cast<long long>(calls);
+    return calls / seconds;
+}
+
+// Runs workers(threads) off the main thread while this thread drains the scheduler, as the idle hook would.
+template <typename Worker> double Queued(unsigned threads, std::size_t callsPerThread, Worker worker)
+{
+    const long long before = mainCounter;
+    std::atomic<unsigned> running{threads};
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&] {
+            worker(callsPerThread);
+            if (--running == 0)
+            {
+                StubCauseIdle(); // let the main thread notice it is done
+            }
+        });
+    }
+
+    auto &scheduler = ae::TaskScheduler::GetInstance();
+    while (running.load() != 0 || scheduler.HasPendingTasks())
+    {
+        {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleWake.wait(lock, [] { return idleRequested; });
+            idleRequested = false;
+        }
+        scheduler.ExecuteTasks();
+    }
+    const double seconds = Seconds(start);
+    for (auto &thread : workers)
+    {
+        thread.join();
+    }
+    failures += mainCounter - before != static_cast<long long>(threads * callsPerThread);
+    return threads * callsPerThread / seconds;
+}
+
+void RoundTrips(std::size_t calls)
+{
+    for (std::size_t i = 0; i < calls; ++i)
+    {
+        ae::ScheduleOrExecute(&Increment).get();
+    }
+}
+
+void Pipelined(std::size_t calls)
+{
+    std::vector<ae::TaskResult<long long>> results;
+    results.reserve(64);
+    for (std::size_t i = 0; i < calls; i += 64)
+    {
+        for (std::size_t j = i; j < calls && j < i + 64; ++j)
+        {
+            results.push_back(ae::ScheduleOrExecute(&Increment));
+        }
+        for (auto &result : results)
+        {
+            result.get();
+        }
+        results.clear();
+    }
+}
+
+// Exceptions thrown by the task must reach the caller on both paths.
+void CheckExceptions()
+{
+    auto fail = []() -> int { throw std::runtime_error("expected"); };
+    auto rethrows = [&] {
+        try
+        {
+            ae::ScheduleOrExecute(fail).get();
+        }
+        catch (const std::runtime_error &)
+        {
+            return true;
+        }
+        return false;
+    };
+    failures += !rethrows();
+    Queued(1, 1, [&](std::size_t) {
+        failures += !rethrows();
+        ae::ScheduleOrExecute(&Increment).get(); // keeps the call count Queued expects
+    });
+}
+} // namespace
+
+int main()
+{
+    StubUtilitySuite.AEGP_CauseIdleRoutinesToBeCalled = &StubCauseIdle;
+    SuiteManager::GetInstance().InitializeSuiteHandler(&StubBasicSuite);
+    ae::TaskScheduler::GetInstance().SetMainThread();
+
+    CheckExceptions();
+    std::printf("inline, on the main thread       %8.2f Mcalls/s\n", Inline(std::size_t(1) << 22) / 1e6);
+    for (unsigned threads : {1u, 4u})
+    {
+        std::printf("queued, %u caller(s), get() each  %8.3f Mcalls/s\n", threads,
+                    Queued(threads, std::size_t(1) << 15, RoundTrips) / 1e6);
+    }
+    std::printf("queued, 1 caller, 64 in flight   %8.3f Mcalls/s\n", Queued(1, std::size_t(1) << 18, Pipelined) / 1e6);
+    if (failures)
+    {
+        std::printf("%d check(s) failed\n", failures.load());
+        return 1;
+    }
+    return 0;
+}